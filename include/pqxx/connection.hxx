@@ -20,6 +20,7 @@
 #include <map>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 #include "pqxx/errorhandler.hxx"
 #include "pqxx/except.hxx"
@@ -59,6 +60,22 @@
 namespace pqxx::internal
 {
 class sql_cursor;
+
+/// A statement waiting to go out along with a later one.
+struct queued_statement
+{
+  /// Query text, or name of a prepared statement.
+  std::shared_ptr<std::string> query;
+  params args{};
+  /// Is @c query the name of a prepared statement?
+  bool prepared = false;
+  /// Queued by write-behind, as opposed to a deferred transaction command.
+  bool write_behind = false;
+  /// A RELEASE SAVEPOINT, which an enclosing commit or abort makes redundant.
+  bool release = false;
+  /// For a RELEASE: how deeply its savepoint is nested.  Top level is 0.
+  std::size_t depth = 0;
+};
 } // namespace pqxx::internal
 
 
@@ -66,6 +83,7 @@ namespace pqxx::internal::gate
 {
 class connection_dbtransaction;
 class connection_errorhandler;
+class connection_group_committer;
 class connection_largeobject;
 class connection_notification_receiver;
 class connection_pipeline;
@@ -685,6 +703,42 @@ private:
   result PQXX_PRIVATE exec(std::shared_ptr<std::string>);
   void PQXX_PRIVATE register_transaction(transaction_base *);
   void PQXX_PRIVATE unregister_transaction(transaction_base *) noexcept;
+  /// Send @c command along with the next statement, not right away.
+  void PQXX_PRIVATE defer(std::string command);
+  /// Queue a statement whose result the caller does not need.
+  void PQXX_PRIVATE write_behind(
+    std::shared_ptr<std::string> query, internal::params &&args,
+    bool prepared);
+  /// Defer a RELEASE SAVEPOINT.  It may never need to go out at all.
+  /** @param depth Nesting depth of the savepoint.
+   */
+  void PQXX_PRIVATE
+  defer_release(std::shared_ptr<std::string> command, std::size_t depth);
+  /// Forget deferred RELEASEs of savepoints nested deeper than @c depth.
+  /** Call this when a transaction at nesting depth @c depth ends: that makes
+   * the RELEASEs of its nested savepoints redundant, but not those of its
+   * siblings' or ancestors' savepoints.  Returns whether it dropped any.
+   */
+  bool PQXX_PRIVATE drop_deferred_releases(std::size_t depth) noexcept;
+  /// Take back the last deferred command, if it is @c command.
+  /** Returns whether it did.  If so, the command was never sent.
+   */
+  bool PQXX_PRIVATE cancel_deferred(std::string_view command) noexcept;
+  /// Drop the deferred statements of a transaction that's aborting.
+  /** If @c command, which started the transaction, is still queued, drops it
+   * and everything after it, and returns true.  Otherwise the transaction
+   * started before anything in the queue, so it drops the whole queue.
+   * An empty @c command never matches.
+   */
+  bool PQXX_PRIVATE discard_deferred(std::string_view command) noexcept;
+  /// Execute any deferred commands, in a round trip of their own.
+  void PQXX_PRIVATE flush_deferred();
+  /// Execute single-statement command; pipeline it with queued statements.
+  result PQXX_PRIVATE exec_single(std::shared_ptr<std::string> command);
+  /// Is the server in a transaction block that has failed?
+  bool PQXX_PRIVATE in_failed_transaction() const noexcept;
+
+  friend class internal::gate::connection_group_committer;
 
   friend class internal::gate::connection_stream_from;
   bool PQXX_PRIVATE read_copy_line(std::string &);
@@ -696,12 +750,30 @@ private:
   friend class internal::gate::connection_largeobject;
   internal::pq::PGconn *raw_connection() const { return m_conn; }
 
+  /// Pipeline queued statements, and optionally one more query.
+  /** If @c query is null, just executes the queued statements.
+   */
+  result PQXX_PRIVATE exec_with_deferred(
+    std::shared_ptr<std::string> const &query, internal::params const &args,
+    bool prepared, format result_format = format::text);
+  bool PQXX_PRIVATE has_write_behind() const noexcept;
+  /// Throw if a queued statement failed.
+  void PQXX_PRIVATE
+  check_queued(internal::queued_statement const &, internal::pq::PGresult *);
+
   friend class internal::gate::connection_notification_receiver;
   void add_receiver(notification_receiver *);
   void remove_receiver(notification_receiver *) noexcept;
 
   friend class internal::gate::connection_pipeline;
   void PQXX_PRIVATE start_exec(char const query[]);
+  void PQXX_PRIVATE
+  start_exec_params(char const query[], internal::params const &);
+  void PQXX_PRIVATE
+  start_exec_prepared(char const statement[], internal::params const &);
+  bool PQXX_PRIVATE enter_pipeline_mode();
+  void PQXX_PRIVATE pipeline_sync();
+  bool PQXX_PRIVATE exit_pipeline_mode() noexcept;
   bool PQXX_PRIVATE consume_input() noexcept;
   bool PQXX_PRIVATE is_busy() const noexcept;
   internal::pq::PGresult *get_result();
@@ -709,7 +781,9 @@ private:
   friend class internal::gate::connection_dbtransaction;
   friend class internal::gate::connection_sql_cursor;
 
-  result exec_params(std::string_view query, internal::params const &args);
+  result exec_params(
+    std::string_view query, internal::params const &args,
+    format result_format = format::text);
 
   /// Connection handle.
   internal::pq::PGconn *m_conn = nullptr;
@@ -726,6 +800,9 @@ private:
 
   /// Unique number to use as suffix for identifiers (see adorn_name()).
   int m_unique_id = 0;
+
+  /// Statements waiting to go out with the next one.
+  std::vector<internal::queued_statement> m_deferred;
 };
 
 
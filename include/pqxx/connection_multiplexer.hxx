@@ -0,0 +1,158 @@
+/* Share one connection between threads, by queueing their queries.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/connection_multiplexer
+ * instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_CONNECTION_MULTIPLEXER
+#define PQXX_H_CONNECTION_MULTIPLEXER
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "pqxx/connection.hxx"
+#include "pqxx/internal/statement_parameters.hxx"
+#include "pqxx/result.hxx"
+
+
+namespace pqxx
+{
+/// Run queries from any number of threads, over a single connection.
+/** A @c connection is for use by one thread at a time.  If many threads each
+ * run the occasional query, giving each its own connection means lots of
+ * mostly idle backend processes on the server.  A multiplexer owns one
+ * connection, and lets any thread submit queries to it.
+ *
+ * A background thread collects the queries that have come in, and sends them
+ * to the server back-to-back in a @c pipeline.  Each result goes to the
+ * @c std::future that the submitting thread got back.
+ *
+ * Each query runs in its own implicit transaction, even within a batch, so a
+ * query that fails only fails by itself.  There is no way to group queries
+ * into a transaction, and each query must consist of a single SQL statement.
+ *
+ * If the connection breaks, every query in the batch whose result had not
+ * come in yet fails, even though the server may have executed it.  The
+ * multiplexer tries to reconnect for the next batch.
+ *
+ * Prepare statements through the multiplexer's @c prepare(), not on the
+ * connection itself.  That way they survive a reconnect.  Parameters are
+ * converted to strings right away, in the thread that submits the query.
+ */
+class PQXX_LIBEXPORT connection_multiplexer
+{
+public:
+  /// Take over connection @c c.  It must not have a transaction open.
+  explicit connection_multiplexer(connection &&c);
+
+  connection_multiplexer(connection_multiplexer const &) = delete;
+  connection_multiplexer &operator=(connection_multiplexer const &) = delete;
+
+  /// Finish all queries that were submitted, then close.
+  ~connection_multiplexer() noexcept;
+
+  /// Queue up an SQL query.
+  [[nodiscard]] std::future<result> exec(std::string query)
+  {
+    return submit(query_kind::text, std::move(query), nullptr);
+  }
+
+  /// Queue up a parameterised query.  Parameters are $1, $2, etc.
+  template<typename... Args>
+  [[nodiscard]] std::future<result>
+  exec_params(std::string query, Args &&... args)
+  {
+    return submit(
+      query_kind::params, std::move(query),
+      std::make_unique<internal::params>(std::forward<Args>(args)...));
+  }
+
+  /// Queue up a prepared statement.
+  template<typename... Args>
+  [[nodiscard]] std::future<result>
+  exec_prepared(std::string statement, Args &&... args)
+  {
+    return submit(
+      query_kind::prepared, std::move(statement),
+      std::make_unique<internal::params>(std::forward<Args>(args)...));
+  }
+
+  /// Define a prepared statement, for use with @c exec_prepared().
+  /** The statement gets prepared before the next batch goes out, and again
+   * whenever the multiplexer reconnects.  The name must not be in use yet.
+   * You can call this from any thread.
+   */
+  void prepare(std::string name, std::string definition);
+
+  /// Number of batches sent to the server so far.
+  [[nodiscard]] std::size_t batches() const noexcept
+  {
+    return m_batches.load(std::memory_order_relaxed);
+  }
+
+private:
+  enum class query_kind
+  {
+    text,
+    params,
+    prepared,
+  };
+
+  /// A submitted query.  Also its own node in the submission stack.
+  struct job
+  {
+    query_kind kind;
+    std::string query;
+    std::unique_ptr<internal::params> args;
+    std::promise<result> done;
+    job *next = nullptr;
+  };
+
+  std::future<result> submit(
+    query_kind, std::string &&query, std::unique_ptr<internal::params> args);
+  void loop() noexcept;
+  void run_batch(std::vector<std::unique_ptr<job>> &batch);
+  void reconnect();
+  void prepare_statements();
+
+  connection m_conn;
+  std::string const m_options;
+
+  /// Statements to prepare on the connection: name and definition.
+  std::vector<std::pair<std::string, std::string>> m_statements;
+  std::mutex m_statements_mutex;
+  /// Number of @c m_statements prepared on the current connection.
+  /** Only the background thread touches this.
+   */
+  std::size_t m_prepared = 0;
+
+  /// Stack of submitted jobs, newest first.  Producers push without locking.
+  std::atomic<job *> m_head{nullptr};
+  /// Only for waking up the background thread.
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::atomic<bool> m_stopping{false};
+  std::atomic<std::size_t> m_batches{0};
+
+  /// Declared last, so the thread starts after everything else is ready.
+  std::thread m_worker;
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
@@ -0,0 +1,250 @@
+/* Thread-safe pools of database connections.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/connection_pool instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_CONNECTION_POOL
+#define PQXX_H_CONNECTION_POOL
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pqxx/connection.hxx"
+
+
+namespace pqxx
+{
+/// A pool of connections to one database, for use from multiple threads.
+/** A @c connection can only be used from one thread at a time.  A pool lets
+ * threads share a limited number of connections: a thread acquires a
+ * @c lease on a connection, uses it, and the lease gives it back to the pool
+ * when it's done.
+ *
+ * The pool opens connections as they are needed, up to its maximum size.  If
+ * all are in use, @c acquire() waits for one to come back.  A connection that
+ * has broken goes away when it comes back, so that the next acquisition opens
+ * a fresh one.
+ *
+ * Each request for a connection has a @c priority.  When connections are
+ * scarce, waiting requests get served highest priority first, and in order of
+ * arrival within a priority.  For each priority you can also limit how many
+ * connections it may use at once, how many requests may wait, and how long
+ * they may wait.  A request that would go over either of the latter two
+ * fails right away, or when its time is up, with @c pool_exhausted.  That way
+ * interactive work can have the connections it needs, even when there's
+ * batch work queueing up.
+ *
+ * Don't leave a transaction open on a connection when you give it back.  The
+ * pool must outlive its leases.
+ */
+class PQXX_LIBEXPORT connection_pool
+{
+public:
+  class lease;
+
+  /// Priority classes for connection requests, from highest to lowest.
+  enum class priority
+  {
+    interactive,
+    normal,
+    batch,
+  };
+
+  /// Queueing statistics for one priority class.
+  struct class_stats
+  {
+    /// Connections leased out to this class right now.
+    std::size_t in_use = 0;
+    /// Requests waiting right now.
+    std::size_t queued = 0;
+    /// Requests that got a connection so far.
+    std::size_t acquired = 0;
+    /// Requests that gave up waiting.
+    std::size_t timeouts = 0;
+    /// Requests that found the queue full.
+    std::size_t rejected = 0;
+    /// Total time successful requests spent waiting.
+    std::chrono::steady_clock::duration total_wait{};
+    /// Longest time a successful request spent waiting.
+    std::chrono::steady_clock::duration max_wait{};
+  };
+
+  /**
+   * @param options Connection string for the connections in the pool.
+   * @param max_size Maximum number of connections to open at the same time.
+   */
+  explicit connection_pool(std::string options, std::size_t max_size = 8);
+
+  connection_pool(connection_pool const &) = delete;
+  connection_pool &operator=(connection_pool const &) = delete;
+  ~connection_pool() noexcept;
+
+  /// Get a connection.  Waits until one is available.
+  /** Waits no longer than the class's queue timeout, if it has one.
+   *
+   * @throw broken_connection if there was no connection available, and
+   * opening a new one failed.
+   * @throw pool_exhausted if the class's queue was full, or its queue timeout
+   * expired.
+   */
+  [[nodiscard]] lease acquire(priority p = priority::normal);
+
+  /// Get a connection, waiting no longer than @c timeout.
+  [[nodiscard]] lease acquire(priority p, std::chrono::milliseconds timeout);
+
+  /// Let class @c p use at most @c limit connections at the same time.
+  void set_class_limit(priority p, std::size_t limit);
+
+  /// Let at most @c max_queued requests of class @c p wait at the same time.
+  void set_max_queued(priority p, std::size_t max_queued);
+
+  /// Make requests of class @c p wait no longer than @c timeout by default.
+  /** Zero means no limit.
+   */
+  void set_queue_timeout(priority p, std::chrono::milliseconds timeout);
+
+  /// Queueing statistics for class @c p.
+  [[nodiscard]] class_stats stats(priority p) const;
+
+  /// Prepare a statement on all of the pool's connections.
+  /** Each connection gets the statement before it is next leased out,
+   * including connections that the pool opens later.  The name must not be
+   * in use yet.
+   */
+  void prepare(std::string name, std::string definition);
+
+  /// The connection string for this pool's connections.
+  [[nodiscard]] std::string const &options() const noexcept
+  {
+    return m_options;
+  }
+
+  /// Maximum number of connections.
+  [[nodiscard]] std::size_t max_size() const noexcept { return m_max_size; }
+
+  /// Number of connections leased out right now.
+  [[nodiscard]] std::size_t in_use() const;
+
+  /// Number of open connections waiting in the pool right now.
+  [[nodiscard]] std::size_t idle() const;
+
+private:
+  static constexpr std::size_t num_classes{3};
+
+  struct priority_class
+  {
+    std::size_t limit;
+    std::size_t max_queued;
+    std::chrono::milliseconds timeout{0};
+    /// Tickets of waiting requests, in order of arrival.
+    std::deque<std::uint64_t> queue;
+    class_stats stats;
+  };
+
+  priority_class &get_class(priority p) noexcept
+  {
+    return m_classes[static_cast<std::size_t>(p)];
+  }
+  priority_class const &get_class(priority p) const noexcept
+  {
+    return m_classes[static_cast<std::size_t>(p)];
+  }
+  /// An idle connection, and how many of our statements it has prepared.
+  struct idle_connection
+  {
+    std::unique_ptr<connection> conn;
+    std::size_t prepared;
+  };
+
+  /// May the oldest waiting request of class @c p have a connection now?
+  bool may_admit(priority p) const noexcept;
+  lease wait_for_connection(
+    priority p, std::chrono::steady_clock::time_point const *deadline);
+  /// Prepare any statements that @c l's connection doesn't have yet.
+  void prepare_statements(lease &l);
+  void give_back(
+    std::unique_ptr<connection> &&, std::size_t prepared, priority) noexcept;
+
+  std::string const m_options;
+  std::size_t const m_max_size;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_available;
+  std::vector<idle_connection> m_idle;
+  /// Connections that are open or opening, whether idle or leased out.
+  std::size_t m_open = 0;
+  std::array<priority_class, num_classes> m_classes;
+  std::uint64_t m_next_ticket = 0;
+  /// Statements to prepare on each connection: name and definition.
+  std::vector<std::pair<std::string, std::string>> m_statements;
+};
+
+
+/// Temporary use of a connection from a @c connection_pool.
+/** Gives the connection back to the pool when destroyed, or when you call
+ * @c release().  Use it like a pointer to the connection.
+ */
+class PQXX_LIBEXPORT connection_pool::lease
+{
+public:
+  lease() = default;
+  lease(lease &&rhs) noexcept :
+          m_pool{rhs.m_pool},
+          m_conn{std::move(rhs.m_conn)},
+          m_priority{rhs.m_priority},
+          m_prepared{rhs.m_prepared}
+  {}
+  lease &operator=(lease &&rhs) noexcept;
+  ~lease() noexcept { release(); }
+
+  [[nodiscard]] connection &operator*() const noexcept { return *m_conn; }
+  [[nodiscard]] connection *operator->() const noexcept
+  {
+    return m_conn.get();
+  }
+  [[nodiscard]] connection *get() const noexcept { return m_conn.get(); }
+
+  /// Does this lease hold a connection?
+  explicit operator bool() const noexcept { return bool(m_conn); }
+
+  /// Give the connection back to the pool.  The lease becomes empty.
+  void release() noexcept;
+
+private:
+  friend class connection_pool;
+  lease(
+    connection_pool &pool, std::unique_ptr<connection> &&conn, priority p,
+    std::size_t prepared) noexcept :
+          m_pool{&pool},
+          m_conn{std::move(conn)},
+          m_priority{p},
+          m_prepared{prepared}
+  {}
+
+  connection_pool *m_pool = nullptr;
+  std::unique_ptr<connection> m_conn;
+  priority m_priority = priority::normal;
+  /// Number of the pool's statements that the connection has prepared.
+  std::size_t m_prepared = 0;
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
@@ -16,7 +16,10 @@
 #include "pqxx/compiler-public.hxx"
 #include "pqxx/internal/compiler-internal-pre.hxx"
 
+#include <chrono>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 
 #include "pqxx/result.hxx"
@@ -159,10 +162,16 @@ public:
   using difference_type = result_difference_type;
 
   /// Create cursor.
+  /** A @c binary cursor fetches its data in binary format, saving the
+   * backend the work of rendering it as text and the client the work of
+   * parsing it.  See field::to() for which types it supports.
+   */
   stateless_cursor(
     transaction_base &trans, std::string_view query, std::string_view cname,
-    bool hold) :
-          m_cur{trans, query, cname, cursor_base::random_access, up, op, hold}
+    bool hold, bool binary = false) :
+          m_cur{
+            trans, query, cname, cursor_base::random_access, up, op, hold,
+            binary}
   {}
 
   /// Adopt existing scrolling SQL cursor.
@@ -198,10 +207,36 @@ public:
    */
   result retrieve(difference_type begin_pos, difference_type end_pos)
   {
+    if (m_cache)
+      return m_cache->retrieve(
+        m_cur, result::difference_type(size()), begin_pos, end_pos);
     return internal::stateless_cursor_retrieve(
       m_cur, result::difference_type(size()), begin_pos, end_pos);
   }
 
+  /// Cache retrieved rows in memory, for repeated or overlapping retrievals.
+  /** The cursor fetches rows in blocks of @c block_rows rows, aligned on
+   * multiples of @c block_rows, and keeps up to @c max_blocks of the most
+   * recently used blocks.  A retrieve() call which falls entirely within one
+   * block gets its rows from the cache, fetching the block if needed.
+   * Other calls go straight to the cursor, as they do without a cache.
+   *
+   * On sequential access, the cursor fetches the next block along with the
+   * one it needs.
+   *
+   * For paging through a result set, choose a block size that is a multiple
+   * of the page size.  Pass zero for either parameter to disable the cache.
+   */
+  void set_cache(difference_type block_rows, std::size_t max_blocks)
+  {
+    if (block_rows < 0)
+      throw range_error{"Negative cursor cache block size."};
+    if (block_rows == 0 or max_blocks == 0)
+      m_cache.reset();
+    else
+      m_cache.emplace(block_rows, max_blocks);
+  }
+
   [[nodiscard]] std::string const &name() const noexcept
   {
     return m_cur.name();
@@ -209,6 +244,7 @@ public:
 
 private:
   internal::sql_cursor m_cur;
+  std::optional<internal::cursor_block_cache> m_cache;
 };
 
 
@@ -216,6 +252,12 @@ class icursor_iterator;
 } // namespace pqxx
 
 
+namespace pqxx::internal
+{
+class cursor_prefetch;
+} // namespace pqxx::internal
+
+
 namespace pqxx::internal::gate
 {
 class icursor_iterator_icursorstream;
@@ -225,6 +267,71 @@ class icursorstream_icursor_iterator;
 
 namespace pqxx
 {
+/// Policy for tuning a cursor stream's stride as it goes.
+/** A small stride wastes round trips; a large one wastes memory, and makes
+ * each individual fetch take longer.  An adaptive_stride watches how wide the
+ * rows are and how long each fetch takes, and picks the number of rows for the
+ * next fetch accordingly.  It grows the stride by at most a factor of 2 per
+ * fetch, but shrinks it as fast as it needs to.
+ *
+ * The next stride is the largest number of rows that:
+ * 1. stays within the byte budget, based on the average row width so far,
+ * 2. and is expected to complete within the latency target,
+ * 3. and stays within the memory cap (if set), based on the widest row so far,
+ * 4. and lies between the minimum and maximum stride.
+ *
+ * The memory cap takes precedence over the minimum stride, except that a
+ * stride is always at least 1.  Row widths count only the field data, not the
+ * overhead of storing it, so leave some headroom in the cap.
+ */
+class PQXX_LIBEXPORT adaptive_stride
+{
+public:
+  using difference_type = cursor_base::difference_type;
+  using duration = std::chrono::steady_clock::duration;
+
+  /**
+   * @param target_bytes Aim to fetch about this many bytes of data at a time.
+   * @param target_latency Aim to complete each fetch within this time.
+   * @param min_stride Fetch at least this many rows at a time.
+   * @param max_stride Fetch at most this many rows at a time.
+   * @param max_bytes Hard memory cap per fetch, in bytes; zero for none.
+   */
+  explicit adaptive_stride(
+    std::size_t target_bytes = 1024 * 1024,
+    duration target_latency = std::chrono::milliseconds{200},
+    difference_type min_stride = 1, difference_type max_stride = 100000,
+    std::size_t max_bytes = 0);
+
+  /// Number of rows to fetch next.
+  [[nodiscard]] difference_type stride() const noexcept { return m_stride; }
+
+  /// Average row width seen so far, in bytes, or zero if not known yet.
+  [[nodiscard]] double row_width() const noexcept { return m_row_width; }
+
+  /// Record a completed fetch, and update stride accordingly.
+  /**
+   * @param rows Number of rows that the fetch returned.
+   * @param bytes Total size of the field data in those rows.
+   * @param widest_row Size of the field data in the widest row.
+   * @param elapsed Time the fetch took.
+   */
+  void observe(
+    difference_type rows, std::size_t bytes, std::size_t widest_row,
+    duration elapsed);
+
+private:
+  std::size_t m_target_bytes;
+  duration m_target_latency;
+  difference_type m_min_stride, m_max_stride;
+  std::size_t m_max_bytes;
+
+  difference_type m_stride;
+  double m_row_width = 0;
+  std::size_t m_widest_row = 0;
+};
+
+
 /// Simple read-only cursor represented as a stream of results
 /** SQL cursors can be tricky, especially in C++ since the two languages seem
  * to have been designed on different planets.  An SQL cursor has two singular
@@ -292,6 +399,8 @@ public:
     transaction_base &context, field const &cname, difference_type sstride = 1,
     cursor_base::ownership_policy op = cursor_base::owned);
 
+  ~icursorstream() noexcept;
+
   operator bool() const noexcept { return not m_done; }
 
   /// Read new value into given result object; same as operator >>
@@ -327,10 +436,44 @@ public:
    * @param stride Must be a positive number
    */
   void set_stride(difference_type stride);
+
+  /// Let the stream tune its own stride, according to the given policy.
+  /** The stride changes after each fetch, based on the size of the rows and
+   * the time the fetch took.  Setting a fixed stride ends adaptive mode.
+   *
+   * While any icursor_iterator exists on this stream, the stride stays fixed.
+   * Iterators measure their positions in strides, so they can't deal with a
+   * stride that changes along the way.
+   */
+  void set_stride(adaptive_stride const &policy);
+
+  /// Current stride.  In adaptive mode, this may change with each fetch.
   [[nodiscard]] difference_type stride() const noexcept { return m_stride; }
 
+  /// Fetch the next block ahead of time, while you process the current one.
+  /** In prefetch mode, as soon as the stream returns a block of rows, it
+   * sends the FETCH for the next block to the backend.  It does not wait for
+   * that to complete, so network and server time overlap with whatever your
+   * application does with the rows in the meantime.
+   *
+   * While a prefetch is in flight, the stream keeps the transaction busy,
+   * just like an open pipeline or stream_from would.  You can't execute other
+   * queries in the transaction until you've read the stream to its end,
+   * switched off prefetching and read one more block, or destroyed the
+   * stream.
+   *
+   * Switching prefetching off does not affect a FETCH that is already in
+   * flight; the next read still uses its result.
+   */
+  void set_prefetch(bool prefetch = true) noexcept { m_prefetch = prefetch; }
+
+  /// Is this stream in prefetch mode?
+  [[nodiscard]] bool prefetching() const noexcept { return m_prefetch; }
+
 private:
   result fetchblock();
+  void start_prefetch();
+  result finish_prefetch();
 
   friend class internal::gate::icursorstream_icursor_iterator;
   size_type forward(size_type n = 1);
@@ -344,6 +487,18 @@ private:
   difference_type m_stride;
   difference_type m_realpos, m_reqpos;
 
+  /// Stride tuning policy, if we're in adaptive mode.
+  std::optional<adaptive_stride> m_adaptive;
+
+  transaction_base &m_context;
+
+  /// Fetch the next block ahead of time?
+  bool m_prefetch = false;
+  /// Keeps the transaction busy while a prefetch is in flight.
+  std::unique_ptr<internal::cursor_prefetch> m_prefetching;
+  /// Rows that were prefetched, but skipped over only in part.
+  result m_leftover;
+
   mutable icursor_iterator *m_iterators;
 
   bool m_done;
@@ -109,6 +109,16 @@ struct PQXX_LIBEXPORT in_doubt_error : failure
 };
 
 
+/// No connection became available from a connection pool in time.
+/** Thrown when a request for a pooled connection would have to wait longer
+ * than its priority class allows, or when that class's queue is full.
+ */
+struct PQXX_LIBEXPORT pool_exhausted : failure
+{
+  explicit pool_exhausted(std::string const &);
+};
+
+
 /// The backend saw itself forced to roll back the ongoing transaction.
 struct PQXX_LIBEXPORT transaction_rollback : sql_error
 {
@@ -23,6 +23,31 @@
 #include "pqxx/strconv.hxx"
 #include "pqxx/types.hxx"
 
+namespace pqxx::internal
+{
+/// Decode a big-endian binary integer of 2, 4, or 8 bytes.
+PQXX_LIBEXPORT long long decode_binary_int(char const data[], std::size_t);
+
+/// Decode a binary IEEE 754 @c float4 or @c float8.
+PQXX_LIBEXPORT double decode_binary_float(char const data[], std::size_t);
+
+/// What a binary-format value holds, as far as libpqxx can decode it.
+enum class binary_kind
+{
+  boolean,
+  integer,
+  floating,
+  text,
+  bytes,
+};
+
+/// Classify a column's binary format by its type's oid.
+/** @throw conversion_error if libpqxx can't decode this type in binary.
+ */
+PQXX_LIBEXPORT binary_kind binary_kind_of(oid type);
+} // namespace pqxx::internal
+
+
 namespace pqxx
 {
 /// Reference to a field in a result set.
@@ -92,6 +117,9 @@ public:
 
   /// What column number in its originating table did this column come from?
   [[nodiscard]] row_size_type table_column() const;
+
+  /// Did this field's data come in binary format, e.g. from a binary cursor?
+  [[nodiscard]] bool is_binary() const noexcept;
   //@}
 
   /**
@@ -124,6 +152,9 @@ public:
   /// Read value into obj; or if null, leave obj untouched and return @c false.
   /** This can be used with optional types (except pointers other than C-style
    * strings).
+   *
+   * If the field is in binary format, this supports only booleans,
+   * arithmetic types, and strings.
    */
   template<typename T>
   auto to(T &obj) const -> typename std::enable_if<
@@ -133,7 +164,10 @@ public:
     auto const bytes{c_str()};
     if (bytes[0] == '\0' and is_null())
       return false;
-    from_string(bytes, obj);
+    if (is_binary())
+      from_binary(obj);
+    else
+      from_string(bytes, obj);
     return true;
   }
 
@@ -221,6 +255,77 @@ protected:
   row_size_type m_col;
 
 private:
+  /// Decode binary-format data into obj.
+  /** The column's type determines how to read the data.  So for instance an
+   * integer column converts to a @c double, but a float column won't convert
+   * to an integer.
+   */
+  template<typename T> void from_binary(T &obj) const
+  {
+    using internal::binary_kind;
+    auto const kind{internal::binary_kind_of(type())};
+    if constexpr (std::is_same_v<T, bool>)
+    {
+      if (kind != binary_kind::boolean or size() != 1)
+        throw_binary_mismatch(type_name<T>);
+      obj = (c_str()[0] != 0);
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+      if (kind != binary_kind::integer)
+        throw_binary_mismatch(type_name<T>);
+      obj = check_cast<T>(
+        internal::decode_binary_int(c_str(), size()), "binary integer");
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+      if (kind == binary_kind::integer)
+        obj = T(internal::decode_binary_int(c_str(), size()));
+      else if (kind == binary_kind::floating)
+        obj = T(internal::decode_binary_float(c_str(), size()));
+      else
+        throw_binary_mismatch(type_name<T>);
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+      // Render values the way they would have come in text format.
+      switch (kind)
+      {
+      case binary_kind::boolean:
+        obj = (c_str()[0] != 0) ? "t" : "f";
+        break;
+      case binary_kind::integer:
+        obj = to_string(internal::decode_binary_int(c_str(), size()));
+        break;
+      case binary_kind::floating:
+        obj = to_string(internal::decode_binary_float(c_str(), size()));
+        break;
+      case binary_kind::text:
+      case binary_kind::bytes: obj = std::string{view()}; break;
+      }
+    }
+    else if constexpr (std::is_constructible_v<T, std::string_view>)
+    {
+      if (kind != binary_kind::text and kind != binary_kind::bytes)
+        throw_binary_mismatch(type_name<T>);
+      obj = T{view()};
+    }
+    else
+    {
+      throw_binary_mismatch(type_name<T>);
+    }
+  }
+
+  template<typename T> void from_binary(std::optional<T> &obj) const
+  {
+    T value;
+    from_binary(value);
+    obj = std::move(value);
+  }
+
+  /// Throw conversion_error: can't convert this binary field to @c target.
+  [[noreturn]] void throw_binary_mismatch(std::string const &target) const;
+
   result m_home;
   result::size_type m_row;
 };
@@ -232,7 +337,10 @@ template<> inline bool field::to<std::string>(std::string &obj) const
   char const *const bytes = c_str();
   if (bytes[0] == '\0' and is_null())
     return false;
-  obj = std::string{bytes, size()};
+  if (is_binary())
+    from_binary(obj);
+  else
+    obj = std::string{bytes, size()};
   return true;
 }
 
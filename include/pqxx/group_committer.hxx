@@ -0,0 +1,126 @@
+/* Group commit: batch small write transactions from many threads.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/group_committer instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_GROUP_COMMITTER
+#define PQXX_H_GROUP_COMMITTER
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "pqxx/transaction_base.hxx"
+
+
+namespace pqxx
+{
+class connection;
+
+
+/// Run small write transactions from many threads, with one commit per batch.
+/** When many threads each commit a tiny transaction, throughput is bound by
+ * the time it takes the server to flush each commit to disk.  A group
+ * committer collects the work from those threads, runs a whole batch of it
+ * in a single transaction, and commits it once.  The cost is a little extra
+ * latency: up to the batching window, plus the time the batch takes.
+ *
+ * Each piece of work runs in its own subtransaction, so if it throws, that
+ * only rolls back its own changes.  Its future gets the exception, and the
+ * rest of the batch goes on.  If the final commit fails, every future in the
+ * batch whose work succeeded gets the commit's error.  An @c in_doubt_error
+ * means nobody knows whether the batch got committed.
+ *
+ * Don't catch SQL errors inside your work function and carry on.  The
+ * server-side transaction stays failed.  The committer notices this when
+ * your function returns: it rolls back your work, and your future gets an
+ * @c sql_error.  The rest of the batch goes on as normal.
+ *
+ * The committer owns its connection while it exists: it works on it from a
+ * thread of its own.  Don't use the connection yourself in the meantime.
+ *
+ * Your work functions run in that background thread, one at a time.  Keep
+ * them short, and don't make them wait for other work in the same committer:
+ * they'd be waiting for themselves.  A function must not commit or abort the
+ * transaction it gets.
+ */
+class PQXX_LIBEXPORT group_committer
+{
+public:
+  /// A piece of work to be committed.
+  using task = std::function<void(transaction_base &)>;
+
+  /**
+   * @param c Connection to work on.  Must not have a transaction open.
+   * @param window How long to wait for more work, once a batch has started.
+   * @param max_batch Most pieces of work to commit in one transaction.
+   */
+  explicit group_committer(
+    connection &c,
+    std::chrono::microseconds window = std::chrono::milliseconds{2},
+    std::size_t max_batch = 100);
+
+  group_committer(group_committer const &) = delete;
+  group_committer &operator=(group_committer const &) = delete;
+
+  /// Finish all outstanding work, then stop.
+  ~group_committer() noexcept;
+
+  /// Queue up @c t to be run and committed.
+  /** The future becomes ready once the batch containing @c t has been
+   * committed, or with an exception if either @c t or the commit failed.
+   *
+   * @throw usage_error if the committer is shutting down.
+   */
+  [[nodiscard]] std::future<void> submit(task t);
+
+  /// Run @c t and wait until it has been committed.
+  void run(task t) { submit(std::move(t)).get(); }
+
+  /// Number of transactions committed so far.
+  [[nodiscard]] std::size_t batches() const;
+
+  /// Number of pieces of work committed so far.
+  [[nodiscard]] std::size_t committed() const;
+
+private:
+  struct job
+  {
+    task func;
+    std::promise<void> done;
+  };
+
+  void loop() noexcept;
+  void run_batch(std::deque<job> &);
+
+  connection &m_conn;
+  std::chrono::microseconds const m_window;
+  std::size_t const m_max_batch;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::deque<job> m_queue;
+  bool m_stopping = false;
+  std::size_t m_batches = 0;
+  std::size_t m_committed = 0;
+
+  /// Declared last, so the thread starts after everything else is ready.
+  std::thread m_worker;
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
@@ -0,0 +1,21 @@
+#include <pqxx/internal/callgate.hxx>
+
+namespace pqxx
+{
+class group_committer;
+}
+
+namespace pqxx::internal::gate
+{
+class PQXX_PRIVATE connection_group_committer : callgate<connection>
+{
+  friend class pqxx::group_committer;
+
+  connection_group_committer(reference x) : super(x) {}
+
+  bool in_failed_transaction() const noexcept
+  {
+    return home().in_failed_transaction();
+  }
+};
+} // namespace pqxx::internal::gate
@@ -6,6 +6,8 @@
 namespace pqxx
 {
 class largeobject;
+class parallel_largeobject_reader;
+class parallel_largeobject_writer;
 }
 
 
@@ -14,10 +16,24 @@ namespace pqxx::internal::gate
 class PQXX_PRIVATE connection_largeobject : callgate<connection>
 {
   friend class pqxx::largeobject;
+  friend class pqxx::parallel_largeobject_reader;
+  friend class pqxx::parallel_largeobject_writer;
 
   connection_largeobject(reference x) : super(x) {}
 
-  pq::PGconn *raw_connection() const { return home().raw_connection(); }
+  result exec_params(
+    std::string_view query, internal::params const &args,
+    format result_format)
+  {
+    return home().exec_params(query, args, result_format);
+  }
+
+  pq::PGconn *raw_connection() const
+  {
+    // We're about to bypass the connection, so get it up to date first.
+    home().flush_deferred();
+    return home().raw_connection();
+  }
 };
 
 
@@ -10,6 +10,18 @@ class PQXX_PRIVATE connection_pipeline : callgate<connection>
   connection_pipeline(reference x) : super(x) {}
 
   void start_exec(char const query[]) { home().start_exec(query); }
+  void start_exec_params(char const query[], internal::params const &args)
+  {
+    home().start_exec_params(query, args);
+  }
+  void
+  start_exec_prepared(char const statement[], internal::params const &args)
+  {
+    home().start_exec_prepared(statement, args);
+  }
+  bool enter_pipeline_mode() { return home().enter_pipeline_mode(); }
+  void pipeline_sync() { home().pipeline_sync(); }
+  bool exit_pipeline_mode() noexcept { return home().exit_pipeline_mode(); }
   pqxx::internal::pq::PGresult *get_result() { return home().get_result(); }
   void cancel_query() { home().cancel_query(); }
 
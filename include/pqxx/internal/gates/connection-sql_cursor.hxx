@@ -15,5 +15,13 @@ class PQXX_PRIVATE connection_sql_cursor : callgate<connection>
   connection_sql_cursor(reference x) : super(x) {}
 
   result exec(char const query[]) { return home().exec(query); }
+
+  void start_exec(char const query[]) { home().start_exec(query); }
+  internal::pq::PGresult *get_result() { return home().get_result(); }
+  result make_result(
+    internal::pq::PGresult *pgr, std::shared_ptr<std::string> const &query)
+  {
+    return home().make_result(pgr, query);
+  }
 };
 } // namespace pqxx::internal::gate
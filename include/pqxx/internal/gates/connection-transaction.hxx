@@ -27,6 +27,43 @@ class PQXX_PRIVATE connection_transaction : callgate<connection>
     home().unregister_transaction(t);
   }
 
+  void defer(std::string command) { home().defer(std::move(command)); }
+  void write_behind(
+    std::shared_ptr<std::string> query, internal::params &&args,
+    bool prepared)
+  {
+    home().write_behind(std::move(query), std::move(args), prepared);
+  }
+  void defer_release(std::shared_ptr<std::string> command, std::size_t depth)
+  {
+    home().defer_release(std::move(command), depth);
+  }
+  bool drop_deferred_releases(std::size_t depth) noexcept
+  {
+    return home().drop_deferred_releases(depth);
+  }
+  bool cancel_deferred(std::string_view command) noexcept
+  {
+    return home().cancel_deferred(command);
+  }
+  bool discard_deferred(std::string_view command) noexcept
+  {
+    return home().discard_deferred(command);
+  }
+  void flush_write_behind()
+  {
+    if (home().has_write_behind())
+      home().flush_deferred();
+  }
+  result exec_single(std::shared_ptr<std::string> command)
+  {
+    return home().exec_single(std::move(command));
+  }
+  bool in_failed_transaction() const noexcept
+  {
+    return home().in_failed_transaction();
+  }
+
   bool read_copy_line(std::string &line)
   {
     return home().read_copy_line(line);
@@ -0,0 +1,37 @@
+#include <pqxx/internal/callgate.hxx>
+
+namespace pqxx
+{
+class connection_multiplexer;
+}
+
+namespace pqxx::internal::gate
+{
+class PQXX_PRIVATE pipeline_connection_multiplexer : callgate<pipeline>
+{
+  friend class pqxx::connection_multiplexer;
+
+  pipeline_connection_multiplexer(reference x) : super(x) {}
+
+  void isolate() noexcept { home().isolate(); }
+
+  pipeline::query_id insert(std::string_view query)
+  {
+    return home().insert_query(pipeline::query_kind::text, query, nullptr);
+  }
+
+  pipeline::query_id
+  insert_params(std::string_view query, std::unique_ptr<params> args)
+  {
+    return home().insert_query(
+      pipeline::query_kind::params, query, std::move(args));
+  }
+
+  pipeline::query_id
+  insert_prepared(std::string_view statement, std::unique_ptr<params> args)
+  {
+    return home().insert_query(
+      pipeline::query_kind::prepared, statement, std::move(args));
+  }
+};
+} // namespace pqxx::internal::gate
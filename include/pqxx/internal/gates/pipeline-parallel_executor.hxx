@@ -0,0 +1,27 @@
+#include <pqxx/internal/callgate.hxx>
+
+namespace pqxx
+{
+class parallel_executor;
+}
+
+namespace pqxx::internal::gate
+{
+class PQXX_PRIVATE pipeline_parallel_executor : callgate<pipeline>
+{
+  friend class pqxx::parallel_executor;
+
+  pipeline_parallel_executor(reference x) : super(x) {}
+
+  void isolate() noexcept { home().isolate(); }
+
+  /// Insert a query, parameterised if @c args is not null.
+  pipeline::query_id
+  insert(std::string_view query, std::unique_ptr<params> args)
+  {
+    auto const kind{
+      args ? pipeline::query_kind::params : pipeline::query_kind::text};
+    return home().insert_query(kind, query, std::move(args));
+  }
+};
+} // namespace pqxx::internal::gate
@@ -0,0 +1,21 @@
+#include <pqxx/internal/callgate.hxx>
+
+namespace pqxx
+{
+class shard_router;
+}
+
+namespace pqxx::internal::gate
+{
+class PQXX_PRIVATE result_shard_router : callgate<result const>
+{
+  friend class pqxx::shard_router;
+
+  result_shard_router(reference x) : super(x) {}
+
+  static result concat(std::vector<result> const &parts)
+  {
+    return result::concat(parts);
+  }
+};
+} // namespace pqxx::internal::gate
@@ -9,5 +9,9 @@ class PQXX_PRIVATE result_sql_cursor : callgate<result const>
   result_sql_cursor(reference x) : super(x) {}
 
   char const *cmd_status() const noexcept { return home().cmd_status(); }
+  result copy_rows(result::size_type begin, result::size_type end) const
+  {
+    return home().copy_rows(begin, end);
+  }
 };
 } // namespace pqxx::internal::gate
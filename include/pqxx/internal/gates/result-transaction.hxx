@@ -0,0 +1,18 @@
+#include <pqxx/internal/callgate.hxx>
+
+namespace pqxx::internal
+{
+class basic_transaction;
+}
+
+namespace pqxx::internal::gate
+{
+class PQXX_PRIVATE result_transaction : callgate<result const>
+{
+  friend class pqxx::internal::basic_transaction;
+
+  result_transaction(reference x) : super(x) {}
+
+  char const *cmd_status() const noexcept { return home().cmd_status(); }
+};
+} // namespace pqxx::internal::gate
@@ -0,0 +1,167 @@
+/** Batch up lookups from many threads, so that one thread does them all.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY.  It's for libpqxx's own use.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_LOOKUP_BATCHER
+#define PQXX_H_LOOKUP_BATCHER
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace pqxx::internal
+{
+/// Outcome of a batched lookup for one key: a value, or an error.
+template<typename VALUE> struct batch_answer
+{
+  VALUE value{};
+  std::exception_ptr error;
+};
+
+
+/// Combines lookups by concurrent threads into batches.
+/** A thread that calls @c get() when no lookup is running becomes the one
+ * that runs the next batch.  The batch contains its own key, and those of
+ * all other threads that are waiting for an answer.  Any thread that calls
+ * @c get() while a batch is running waits for it to finish, and then joins
+ * the next batch.
+ *
+ * If the lookup function throws, every key in the batch gets that error.
+ *
+ * Several threads may wait for the same key at the same time.  The lookup
+ * function sees that key only once, and each of those threads gets the
+ * answer.
+ */
+template<typename VALUE> class lookup_batcher
+{
+public:
+  using answers = std::map<std::string, batch_answer<VALUE>>;
+  using lookup_function =
+    std::function<answers(std::vector<std::string> const &)>;
+
+  explicit lookup_batcher(lookup_function lookup) :
+          m_lookup{std::move(lookup)}
+  {}
+
+  /// Look up @c key, in a batch with those of any other waiting threads.
+  /** A key that the lookup function leaves out of its answers gets a
+   * default-constructed value.
+   */
+  VALUE get(std::string const &key)
+  {
+    std::unique_lock<std::mutex> lock{m_lock};
+    // Every caller gets its own entry, even if its key is already waiting.
+    auto const entry{m_pending.emplace(key, pending{})};
+    try
+    {
+      while (not entry->second.done)
+      {
+        if (m_busy)
+        {
+          m_done.wait(lock);
+          continue;
+        }
+        // Equal keys are adjacent in the map, so this skips duplicates.
+        std::vector<std::string> keys;
+        for (auto &[k, state] : m_pending)
+        {
+          if (state.done)
+            continue;
+          state.queued = true;
+          if (std::empty(keys) or keys.back() != k)
+            keys.push_back(k);
+        }
+        run_batch(lock, keys);
+      }
+    }
+    catch (...)
+    {
+      m_pending.erase(entry);
+      throw;
+    }
+
+    auto const answer{std::move(entry->second.answer)};
+    m_pending.erase(entry);
+    if (answer.error)
+      std::rethrow_exception(answer.error);
+    return answer.value;
+  }
+
+private:
+  struct pending
+  {
+    batch_answer<VALUE> answer;
+    /// Is this entry's key part of the batch that's running?
+    bool queued = false;
+    bool done = false;
+  };
+
+  /// Look up @c keys, with @c lock released in the meantime.
+  /** Whatever happens, this marks all entries in the batch done and wakes up
+   * the threads that are waiting for them.  Entries that arrived while the
+   * lookup ran wait for the next batch.
+   */
+  void run_batch(
+    std::unique_lock<std::mutex> &lock, std::vector<std::string> const &keys)
+  {
+    m_busy = true;
+    lock.unlock();
+    answers outcome;
+    std::exception_ptr failure;
+    try
+    {
+      outcome = m_lookup(keys);
+    }
+    catch (...)
+    {
+      failure = std::current_exception();
+    }
+    lock.lock();
+    m_busy = false;
+
+    for (auto &[k, state] : m_pending)
+    {
+      if (state.done or not state.queued)
+        continue;
+      state.done = true;
+      if (failure)
+      {
+        state.answer.error = failure;
+      }
+      else
+      {
+        // Copy, not move: other entries may be waiting for the same key.
+        auto const found{outcome.find(k)};
+        if (found != std::end(outcome))
+          state.answer = found->second;
+      }
+    }
+    m_done.notify_all();
+  }
+
+  lookup_function const m_lookup;
+  std::mutex m_lock;
+  std::condition_variable m_done;
+  /// Keys whose threads are waiting for answers, one entry per thread.
+  std::multimap<std::string, pending> m_pending;
+  /// Is a thread currently running a batch?
+  bool m_busy = false;
+};
+} // namespace pqxx::internal
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
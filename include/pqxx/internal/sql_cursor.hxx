@@ -11,6 +11,9 @@
 #ifndef PQXX_H_SQL_CURSOR
 #define PQXX_H_SQL_CURSOR
 
+#include <list>
+#include <map>
+
 namespace pqxx::internal
 {
 /// Cursor with SQL positioning semantics.
@@ -34,7 +37,7 @@ public:
   sql_cursor(
     transaction_base &t, std::string_view query, std::string_view cname,
     cursor_base::access_policy ap, cursor_base::update_policy up,
-    cursor_base::ownership_policy op, bool hold);
+    cursor_base::ownership_policy op, bool hold, bool binary = false);
 
   sql_cursor(
     transaction_base &t, std::string_view cname,
@@ -48,6 +51,20 @@ public:
     difference_type d = 0;
     return fetch(rows, d);
   }
+  /// Send a FETCH to the backend, but don't wait for its result.
+  /** Until you call finish_fetch(), the connection is busy.  Don't do
+   * anything else with it in the meantime, not even through this cursor.
+   */
+  void start_fetch(difference_type rows);
+  /// Wait for the result of the FETCH sent by start_fetch().
+  result finish_fetch(difference_type &displacement);
+  /// Number of rows requested by start_fetch(), or zero if none pending.
+  difference_type pending_fetch() const noexcept { return m_pending_fetch; }
+
+  /// Copy a range of rows from a result fetched from this cursor.
+  static result
+  copy_rows(result const &, result::size_type begin, result::size_type end);
+
   difference_type move(difference_type rows, difference_type &displacement);
   difference_type move(difference_type rows)
   {
@@ -107,6 +124,9 @@ private:
 
   /// End position, or -1 for unknown
   difference_type m_endpos = -1;
+
+  /// Rows requested by a FETCH that we sent but whose result isn't in.
+  difference_type m_pending_fetch = 0;
 };
 
 
@@ -114,5 +134,53 @@ PQXX_LIBEXPORT result_size_type obtain_stateless_cursor_size(sql_cursor &);
 PQXX_LIBEXPORT result stateless_cursor_retrieve(
   sql_cursor &, result::difference_type size,
   result::difference_type begin_pos, result::difference_type end_pos);
+
+
+/// LRU cache of aligned blocks of rows, for stateless_cursor.
+/** Rows are fetched in blocks of a fixed number of rows, aligned to multiples
+ * of that number.  A retrieval that falls within a single block is served
+ * from the cache, fetching the block first if needed.  Others bypass the
+ * cache.
+ *
+ * When a miss comes right after an access to the preceding block, the cache
+ * fetches the next block along with it, in the same round trip.
+ */
+class PQXX_LIBEXPORT cursor_block_cache
+{
+public:
+  using difference_type = result::difference_type;
+
+  cursor_block_cache(difference_type block_rows, std::size_t max_blocks);
+
+  /// Retrieve rows, with the same semantics as stateless_cursor_retrieve.
+  result retrieve(
+    sql_cursor &, difference_type size, difference_type begin_pos,
+    difference_type end_pos);
+
+  /// Number of retrievals served from cache.
+  std::size_t hits() const noexcept { return m_hits; }
+  /// Number of retrievals which needed a fetch, through the cache or not.
+  std::size_t misses() const noexcept { return m_misses; }
+
+private:
+  using block_list = std::list<std::pair<difference_type, result>>;
+
+  /// Find or fetch block number @c index.
+  result const &
+  get_block(sql_cursor &, difference_type size, difference_type index);
+  void add_block(difference_type index, result const &);
+
+  difference_type m_block_rows;
+  std::size_t m_max_blocks;
+
+  /// Cached blocks, most recently used first.
+  block_list m_blocks;
+  std::map<difference_type, block_list::iterator> m_index;
+
+  /// Block used by the most recent retrieval, if any.
+  difference_type m_last_block = -1;
+
+  std::size_t m_hits = 0, m_misses = 0;
+};
 } // namespace pqxx::internal
 #endif
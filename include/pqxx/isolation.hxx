@@ -29,6 +29,22 @@ enum class write_policy
 };
 
 
+/// When should a transaction start on the backend?
+/** With @c eager, the constructor starts the transaction (or, for a
+ * subtransaction, sets its savepoint) right away.  That takes a round trip
+ * to the database before you've done any real work.
+ *
+ * With @c lazy, the command that starts the transaction waits, and goes out
+ * together with the transaction's first statement.  A transaction which never
+ * executes anything never talks to the database at all, not even to commit.
+ */
+enum class begin_policy
+{
+  eager,
+  lazy
+};
+
+
 /// Transaction isolation levels.
 /** These are as defined in the SQL standard.  But there are a few notes
  * specific to PostgreSQL.
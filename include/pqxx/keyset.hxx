@@ -0,0 +1,124 @@
+/* Keyset pagination, as an alternative to cursors.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/keyset instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_KEYSET
+#define PQXX_H_KEYSET
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pqxx/connection.hxx"
+#include "pqxx/result.hxx"
+
+
+namespace pqxx
+{
+/// Page through a query's results by key, without keeping a cursor open.
+/** A cursor keeps its transaction, and with it a snapshot, open for as long
+ * as you read from it.  On a busy database, that holds back vacuum for the
+ * whole duration of a long scan.
+ *
+ * A keyset_iterator reads the rows in order of a unique key instead, one
+ * block at a time, and each block in its own short read-only transaction.
+ * It remembers the last key it read, and asks for the next block using
+ * <tt>WHERE (k1, k2, ...) > (last1, last2, ...) ORDER BY k1, k2, ...
+ * LIMIT n</tt>.  With an index on the key, each block costs about the same
+ * no matter how far along the scan is.
+ *
+ * The interface is that of icursorstream: read blocks of rows using get() or
+ * @c >>, until the stream evaluates as @c false.
+ *
+ * Since each block comes from a different transaction, the scan as a whole
+ * does not see a consistent snapshot.  Rows inserted or deleted during the
+ * scan may or may not show up.  No row shows up twice, though, provided its
+ * key does not change.
+ *
+ * The iterator prepares two statements on the connection, and unprepares
+ * them when it is destroyed.  Don't have a transaction open on the
+ * connection while reading from the iterator.
+ */
+class PQXX_LIBEXPORT keyset_iterator
+{
+public:
+  using size_type = result_size_type;
+  using difference_type = result_difference_type;
+
+  /// Set up keyset pagination for a query.
+  /**
+   * @param conn Connection on which to run the query.
+   * @param query SQL query whose results this iterator shall read.  It must
+   * not have its own @c ORDER BY or @c LIMIT.
+   * @param keys Names of the key columns in the query's output.  Together
+   * they must be unique, and never null.
+   * @param sstride Maximum number of rows to fetch per block; must be a
+   * positive number.
+   */
+  keyset_iterator(
+    connection &conn, std::string_view query, std::vector<std::string> keys,
+    difference_type sstride = 1000);
+
+  ~keyset_iterator() noexcept;
+
+  keyset_iterator(keyset_iterator const &) = delete;
+  keyset_iterator &operator=(keyset_iterator const &) = delete;
+
+  operator bool() const noexcept { return not m_done; }
+
+  /// Read the next block of rows into given result object.
+  /** The result set may contain any number of rows from zero to the chosen
+   * stride, inclusive.  An empty result will only be returned if there are no
+   * more rows to retrieve.
+   */
+  keyset_iterator &get(result &res)
+  {
+    res = fetchblock();
+    return *this;
+  }
+  /// Read the next block of rows into given result object; same as get().
+  keyset_iterator &operator>>(result &res) { return get(res); }
+
+  /// Change stride, i.e. the maximum number of rows to fetch per block.
+  void set_stride(difference_type stride);
+
+  [[nodiscard]] difference_type stride() const noexcept { return m_stride; }
+
+  /// The key of the last row read so far, in text form.
+  /** Empty if no rows have been read yet.  You can save this and pass it to
+   * resume_after() later, to continue the scan from where it left off.
+   */
+  [[nodiscard]] std::vector<std::string> const &last_key() const noexcept
+  {
+    return m_last_key;
+  }
+
+  /// Continue the scan after the given key.
+  void resume_after(std::vector<std::string> key);
+
+private:
+  result fetchblock();
+
+  connection &m_conn;
+  std::vector<std::string> m_keys;
+  std::vector<std::string> m_last_key;
+
+  /// Prepared statements for the first block, and for subsequent blocks.
+  std::string m_first, m_next;
+
+  difference_type m_stride;
+  bool m_done = false;
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
@@ -16,11 +16,21 @@
 #include "pqxx/compiler-public.hxx"
 #include "pqxx/internal/compiler-internal-pre.hxx"
 
+#include <functional>
+#include <memory>
 #include <streambuf>
+#include <string>
+#include <vector>
 
 #include "pqxx/dbtransaction.hxx"
 
 
+namespace pqxx::internal
+{
+class lo_read_ahead;
+} // namespace pqxx::internal
+
+
 namespace pqxx
 {
 /// Identity of a large object
@@ -36,6 +46,16 @@ class PQXX_LIBEXPORT largeobject
 public:
   using size_type = large_object_size_type;
 
+  /// Callback for progress of a file transfer.
+  /** Receives the number of bytes transferred so far, and the total number of
+   * bytes to transfer, or -1 if the total is not known.
+   */
+  using progress_callback =
+    std::function<void(size_type done, size_type total)>;
+
+  /// Default chunk size for import_file() and export_file(): 1 MiB.
+  static constexpr std::size_t default_chunk_size{1024 * 1024};
+
   /// Refer to a nonexistent large object (similar to what a null pointer
   /// does).
   largeobject() noexcept = default;
@@ -54,11 +74,31 @@ public:
 
   /// Import large object from a local file.
   /** Creates a large object containing the data found in the given file.
+   *
+   * This uses libpq's @c lo_import(), which transfers the data in small
+   * pieces.  For large files, import_file() is faster.
+   *
    * @param t Backend transaction in which the large object is to be created.
    * @param file A filename on the client program's filesystem.
    */
   largeobject(dbtransaction &t, std::string_view file);
 
+  /// Import large object from a local file, in large chunks.
+  /** Creates a large object containing the data found in the given file.
+   * Where the system supports it, the file is memory-mapped, so the data goes
+   * straight from the file to the connection without intermediate copies.
+   *
+   * @param t Backend transaction in which the large object is to be created.
+   * @param file A filename on the client program's filesystem.
+   * @param chunk_size Number of bytes to send per write.  Bigger chunks mean
+   * fewer round trips.  Chunks are capped at 1 GB.
+   * @param progress Optional callback, called after each chunk.
+   */
+  [[nodiscard]] static largeobject import_file(
+    dbtransaction &t, std::string_view file,
+    std::size_t chunk_size = default_chunk_size,
+    progress_callback const &progress = {});
+
   /// Take identity of an opened large object.
   /** Copy identity of already opened large object.  Note that this may be done
    * as an implicit conversion.
@@ -126,6 +166,22 @@ public:
    */
   void to_file(dbtransaction &t, std::string_view file) const;
 
+  /// Export large object's contents to a local file, in large chunks.
+  /** Writes the data stored in the large object to the given file.  Where
+   * the system supports it, the file is memory-mapped, so the data goes
+   * straight from the connection into the file without intermediate copies.
+   *
+   * @param t Transaction in which the object is to be accessed.
+   * @param file A filename on the client's filesystem.
+   * @param chunk_size Number of bytes to read per round trip.  Chunks are
+   * capped at 1 GB.
+   * @param progress Optional callback, called after each chunk.
+   */
+  void export_file(
+    dbtransaction &t, std::string_view file,
+    std::size_t chunk_size = default_chunk_size,
+    progress_callback const &progress = {}) const;
+
   /// Delete large object from database
   /** Unlike its low-level equivalent cunlink, this will throw an exception if
    * deletion fails.
@@ -140,6 +196,8 @@ protected:
   PQXX_PRIVATE std::string reason(connection const &, int err) const;
 
 private:
+  friend class internal::lo_read_ahead;
+
   oid m_id = oid_none;
 };
 
@@ -336,6 +394,8 @@ public:
   largeobjectaccess operator=(largeobjectaccess const &) = delete;
 
 private:
+  template<typename CHAR, typename TRAITS> friend class largeobject_streambuf;
+
   PQXX_PRIVATE std::string reason(int err) const;
   internal::pq::PGconn *raw_connection() const
   {
@@ -350,6 +410,165 @@ private:
 };
 
 
+/// Read a large object over several connections at once.
+/** A single connection does one @c lo_read() round trip at a time.  For a
+ * big object over a high-latency link, that makes the transfer slow.  This
+ * class splits the object into chunks, and reads them concurrently: one
+ * thread per connection, each in its own read-only transaction.  Each chunk
+ * takes one @c lo_get() call, so this needs backend version 9.4 or better.
+ *
+ * Chunks arrive in no particular order.  Each one comes with its offset in
+ * the object, so you can put them in the right place.
+ *
+ * None of the connections may have a transaction open during a read.  Each
+ * worker reads the object in a separate transaction, so if the object
+ * changes during the read, the result may mix old and new data.
+ */
+class PQXX_LIBEXPORT parallel_largeobject_reader
+{
+public:
+  using size_type = large_object_size_type;
+
+  /// Receives a chunk of data, and its offset in the object.
+  /** Calls to a sink never overlap, but they come from different threads.
+   */
+  using sink = std::function<void(size_type offset, std::string_view data)>;
+
+  /**
+   * @param conns Connections to use.  Each gets its own worker thread.
+   * @param obj Large object to read.
+   * @param chunk_size Number of bytes per chunk.
+   */
+  parallel_largeobject_reader(
+    std::vector<connection *> conns, largeobject obj,
+    std::size_t chunk_size = largeobject::default_chunk_size);
+
+  /// Size of the large object, in bytes.
+  [[nodiscard]] size_type size();
+
+  /// Read the whole object, passing each chunk to @c out.
+  void read(sink const &out);
+
+  /// Read the whole object into a local file.
+  void read_to_file(std::string_view file);
+
+  /// Read the whole object into memory.
+  [[nodiscard]] std::string read_all();
+
+private:
+  std::vector<connection *> m_conns;
+  largeobject m_obj;
+  std::size_t m_chunk_size;
+  size_type m_size = -1;
+};
+
+
+/// Write a large object over several connections at once.
+/** This is the write counterpart to parallel_largeobject_reader.  It splits
+ * the data into chunks, and writes them concurrently: one thread per
+ * connection, each in its own transaction.  Each chunk takes one
+ * @c lo_put() call, so this needs backend version 9.4 or better.
+ *
+ * The large object must already exist, and its creation must be committed,
+ * so that all connections can see it.  The writer first truncates the
+ * object to the size of the new data, and commits that.
+ *
+ * The write as a whole is not atomic.  Each worker commits its own
+ * transaction.  So if a worker fails, the object stays truncated, and holds
+ * whatever chunks the other workers wrote.  The old contents are lost; if
+ * you need them in that case, write to a new object instead.
+ *
+ * None of the connections may have a transaction open during a write.
+ */
+class PQXX_LIBEXPORT parallel_largeobject_writer
+{
+public:
+  using size_type = large_object_size_type;
+
+  /// Fills @c buf with @c len bytes of data, from position @c offset.
+  /** Calls to a source never overlap, but they come from different threads.
+   */
+  using source =
+    std::function<void(size_type offset, char buf[], std::size_t len)>;
+
+  /**
+   * @param conns Connections to use.  Each gets its own worker thread.
+   * @param obj Large object to write.
+   * @param chunk_size Number of bytes per chunk.
+   */
+  parallel_largeobject_writer(
+    std::vector<connection *> conns, largeobject obj,
+    std::size_t chunk_size = largeobject::default_chunk_size);
+
+  /// Write @c total bytes, obtained from @c in.
+  /** If this throws, the object may be left truncated and partly written.
+   */
+  void write(size_type total, source const &in);
+
+  /// Write data from memory.
+  void write(std::string_view data);
+
+  /// Write the contents of a local file.
+  void write_file(std::string_view file);
+
+private:
+  using fill_function =
+    std::function<char const *(size_type offset, char buf[], std::size_t)>;
+  void write_chunks(size_type total, fill_function const &);
+
+  std::vector<connection *> m_conns;
+  largeobject m_obj;
+  std::size_t m_chunk_size;
+};
+
+
+namespace internal
+{
+/// Keeps @c loread() calls in flight ahead of a large object stream.
+/** Each call reads the next chunk of the object, and advances the object's
+ * read position.  Where libpq supports pipeline mode, several calls can be
+ * in flight at once.  Otherwise, there is at most one.
+ *
+ * While any calls are in flight, this object keeps the transaction busy.
+ */
+class PQXX_LIBEXPORT lo_read_ahead : public transactionfocus
+{
+public:
+  lo_read_ahead(dbtransaction &t, int fd, std::size_t chunk_size, int depth);
+  ~lo_read_ahead() noexcept;
+
+  /// Receive the next chunk into @c buf, and request another.
+  /** Returns the number of bytes read, which is zero at the end of the
+   * object.  The buffer must have room for a full chunk.
+   */
+  std::size_t read(char buf[]);
+
+  /// Stop reading ahead.
+  /** Returns the number of bytes that were read ahead, but not consumed.
+   * The object's read position is that many bytes further along than the
+   * consumer's.
+   *
+   * Even if reads failed, this consumes all outstanding results and ends
+   * pipeline mode before it throws the first error.
+   */
+  std::size_t stop();
+
+private:
+  void send();
+  /// Receive oldest pending chunk; copy it into buf if not null.
+  std::size_t receive(char buf[]);
+
+  internal::pq::PGconn *const m_conn;
+  std::string const m_fd, m_chunk_text;
+  std::size_t const m_chunk_size;
+  int const m_depth;
+  int m_in_flight = 0;
+  bool m_pipeline = false;
+  bool m_eof = false;
+};
+} // namespace internal
+
+
 /// Streambuf to use large objects in standard I/O streams.
 /** The standard streambuf classes provide uniform access to data storage such
  * as files or string buffers, so they can be accessed using standard input or
@@ -406,6 +625,31 @@ public:
   /// For use by large object stream classes.
   void process_notice(std::string const &s) { m_obj.process_notice(s); }
 
+  /// Keep up to @c depth reads in flight, ahead of what you consume.
+  /** In read-ahead mode, the stream requests the next buffer's worth of data
+   * while you work through the current one, so that network latency
+   * overlaps with your processing.  With libpq's pipeline mode (PostgreSQL
+   * 14 and up), it can have multiple reads in flight; otherwise, at most
+   * one.  Use a bigger buffer size to make each read count.
+   *
+   * While reads are in flight, the stream keeps the transaction busy.  You
+   * can't execute queries in the transaction until you've read to the end of
+   * the object, seeked, set the depth to zero, or destroyed the stream.
+   *
+   * Read-ahead works only on streams that are open for reading only.  Pass
+   * zero to switch it off.
+   */
+  void set_read_ahead(int depth)
+  {
+    if (depth < 0)
+      throw range_error{"Negative large object read-ahead depth."};
+    if (depth > 0 and m_p != nullptr)
+      throw usage_error{
+        "Large object read-ahead only works on read-only streams."};
+    stop_read_ahead();
+    m_read_ahead = depth;
+  }
+
 protected:
   virtual int sync() override
   {
@@ -416,11 +660,15 @@ protected:
 
   virtual pos_type seekoff(off_type offset, seekdir dir, openmode) override
   {
+    // If we read ahead, the object's position is beyond the stream's.
+    if (auto const ahead{stop_read_ahead()}; dir == std::ios::cur)
+      offset -= off_type(ahead);
     return adjust_eof(m_obj.cseek(largeobjectaccess::off_type(offset), dir));
   }
 
   virtual pos_type seekpos(pos_type pos, openmode) override
   {
+    stop_read_ahead();
     largeobjectaccess::pos_type const newpos{
       m_obj.cseek(largeobjectaccess::off_type(pos), std::ios::beg)};
     return adjust_eof(newpos);
@@ -461,6 +709,16 @@ protected:
     if (this->gptr() == nullptr)
       return eof();
     auto *const eb{this->eback()};
+    if (m_read_ahead > 0)
+    {
+      if (not m_ahead)
+        m_ahead = std::make_unique<internal::lo_read_ahead>(
+          m_obj.m_trans, m_obj.m_fd, static_cast<std::size_t>(m_bufsize),
+          m_read_ahead);
+      auto const got{m_ahead->read(eb)};
+      this->setg(eb, eb, eb + got);
+      return (got == 0) ? eof() : traits_type::to_int_type(*eb);
+    }
     auto const res{adjust_eof(
       m_obj.cread(this->eback(), static_cast<std::size_t>(m_bufsize)))};
     this->setg(
@@ -487,6 +745,21 @@ private:
     }
   }
 
+  /// Stop any read-ahead, and discard the get area.
+  /** Returns how many bytes the object's position is ahead of the stream's.
+   */
+  std::size_t stop_read_ahead()
+  {
+    if (not m_ahead)
+      return 0;
+    auto const buffered{
+      static_cast<std::size_t>(this->egptr() - this->gptr())};
+    auto const ahead{m_ahead->stop() + buffered};
+    m_ahead.reset();
+    this->setg(m_g, m_g, m_g);
+    return ahead;
+  }
+
   void initialize(openmode mode)
   {
     if ((mode & std::ios::in) != 0)
@@ -506,6 +779,11 @@ private:
 
   /// Get & put buffers.
   char_type *m_g, *m_p;
+
+  /// Maximum number of reads to keep in flight; zero for none.
+  int m_read_ahead = 0;
+  /// Reads in flight, if in read-ahead mode.
+  std::unique_ptr<internal::lo_read_ahead> m_ahead;
 };
 
 
@@ -558,6 +836,11 @@ public:
     super::init(&m_buf);
   }
 
+  /// Keep up to @c depth reads in flight.
+  /** See largeobject_streambuf::set_read_ahead().
+   */
+  void set_read_ahead(int depth) { m_buf.set_read_ahead(depth); }
+
 private:
   largeobject_streambuf<CHAR, TRAITS> m_buf;
 };
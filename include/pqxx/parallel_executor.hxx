@@ -0,0 +1,133 @@
+/* Run many independent queries in parallel, over a pool of connections.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/parallel_executor instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_PARALLEL_EXECUTOR
+#define PQXX_H_PARALLEL_EXECUTOR
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pqxx/connection_pool.hxx"
+#include "pqxx/internal/statement_parameters.hxx"
+#include "pqxx/result.hxx"
+
+
+namespace pqxx
+{
+/// Run a batch of independent queries in parallel, over pooled connections.
+/** Add your queries with @c add() or @c add_params(), then call @c run().  It
+ * runs them using one thread per connection, several at a time on each
+ * connection in a @c pipeline, and returns their outcomes in the order in
+ * which you added them.
+ *
+ * The queries get divided between the threads up front.  A thread that runs
+ * out of work steals some from another thread, so that a few slow queries
+ * don't hold up the rest.  A thread that finds no connection free in the
+ * pool leaves its share to threads that have one, so it's safe to call
+ * @c run() while you hold some of the pool's connections yourself.
+ *
+ * Each query runs in its own implicit transaction, on whatever connection is
+ * free, so a query that fails only fails by itself.  Don't rely on any
+ * ordering between the queries, or on them seeing each other's changes.  Each
+ * query must consist of a single SQL statement.
+ *
+ * A query can have a timeout, counting from the start of @c run().  If it
+ * hasn't started by then, it doesn't run.  If it has, the server cancels it.
+ * Either way its outcome holds an @c sql_error with SQLSTATE 57014
+ * ("query_canceled").
+ *
+ * An executor is for use by one thread.
+ */
+class PQXX_LIBEXPORT parallel_executor
+{
+public:
+  /// The outcome of one query: a result, or an error.
+  struct outcome
+  {
+    result res;
+    /// If the query failed, its exception.
+    std::exception_ptr error;
+
+    [[nodiscard]] bool ok() const noexcept { return not error; }
+
+    /// The query's result.  Re-throws the query's exception if it failed.
+    result const &get() const
+    {
+      if (error)
+        std::rethrow_exception(error);
+      return res;
+    }
+  };
+
+  /**
+   * @param pool Pool to take connections from.
+   * @param threads Most connections to use at the same time.  Zero means the
+   * pool's maximum size.
+   * @param depth Most queries to pipeline on a connection at a time.
+   */
+  explicit parallel_executor(
+    connection_pool &pool, std::size_t threads = 0, std::size_t depth = 8);
+
+  ~parallel_executor() noexcept;
+
+  /// Add a query.  Returns its index in the outcomes of @c run().
+  std::size_t add(std::string query)
+  {
+    return add_task(std::move(query), nullptr);
+  }
+
+  /// Add a parameterised query.  Parameters are $1, $2, etc.
+  template<typename... Args>
+  std::size_t add_params(std::string query, Args &&... args)
+  {
+    return add_task(
+      std::move(query),
+      std::make_unique<internal::params>(std::forward<Args>(args)...));
+  }
+
+  /// Set a timeout for query number @c task.
+  void set_timeout(std::size_t task, std::chrono::milliseconds timeout);
+
+  /// Number of queries waiting for @c run().
+  [[nodiscard]] std::size_t size() const noexcept { return m_tasks.size(); }
+
+  /// Run all queries that were added.  Returns outcomes in the same order.
+  /** Afterwards, the executor is empty and ready for a new batch.
+   */
+  std::vector<outcome> run();
+
+private:
+  struct task
+  {
+    std::string query;
+    /// Parameters, or null for a plain query.
+    std::unique_ptr<internal::params> args;
+    /// Zero for none.
+    std::chrono::milliseconds timeout{0};
+  };
+  class scheduler;
+
+  std::size_t add_task(std::string &&, std::unique_ptr<internal::params>);
+
+  connection_pool &m_pool;
+  std::size_t const m_threads;
+  std::size_t const m_depth;
+  std::vector<task> m_tasks;
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
@@ -16,13 +16,26 @@
 #include "pqxx/compiler-public.hxx"
 #include "pqxx/internal/compiler-internal-pre.hxx"
 
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
 #include <limits>
-#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "pqxx/transaction_base.hxx"
 
 
+namespace pqxx::internal::gate
+{
+class pipeline_connection_multiplexer;
+class pipeline_parallel_executor;
+} // namespace pqxx::internal::gate
+
+
 namespace pqxx
 {
 /// Processes several queries in FIFO manner, optimized for high throughput.
@@ -38,12 +51,35 @@ namespace pqxx
  * Generally, if any of the queries fails, it will throw an exception at the
  * point where you request its result.  But it may happen earlier, especially
  * if you request results out of chronological order.
+ *
+ * Instead of retrieving a result yourself, you can also have the pipeline
+ * pass it to a completion handler, or to a @c std::future.  That way, several
+ * independent parts of your application can share one pipeline.
  */
 class PQXX_LIBEXPORT pipeline : public internal::transactionfocus
 {
 public:
   using query_id = long;
 
+  /// Function to call when a query completes.
+  /** Receives the query's identifier and its result.  If the query failed,
+   * the @c std::exception_ptr points to the exception that @c retrieve()
+   * would have thrown; otherwise it is null.
+   */
+  using completion_handler =
+    std::function<void(query_id, result const &, std::exception_ptr)>;
+
+  /// Timing information for one batch of queries sent to the backend.
+  struct batch_stats
+  {
+    /// Number of queries in the batch.
+    int queries = 0;
+    /// Time from sending the batch until its first result came in.
+    std::chrono::steady_clock::duration first_result{};
+    /// Time from sending the batch until its last result came in.
+    std::chrono::steady_clock::duration last_result{};
+  };
+
   pipeline(pipeline const &) = delete;
   pipeline &operator=(pipeline const &) = delete;
 
@@ -81,7 +117,63 @@ public:
    *
    * @return Identifier for this query, unique only within this pipeline.
    */
-  query_id insert(std::string_view);
+  query_id insert(std::string_view q)
+  {
+    return insert_query(query_kind::text, q, nullptr);
+  }
+
+  /// Add query to the pipeline, and have a handler called on completion.
+  /** Equivalent to @c insert() followed by @c on_complete().
+   */
+  query_id insert(std::string_view q, completion_handler handler)
+  {
+    auto const qid{insert(q)};
+    on_complete(qid, std::move(handler));
+    return qid;
+  }
+
+  /// Add query to the pipeline, and get a future for its result.
+  /** Equivalent to @c insert() followed by @c get_future().
+   */
+  std::future<result> insert_future(std::string_view q)
+  {
+    return get_future(insert(q));
+  }
+
+  /// Add parameterised query to the pipeline.
+  /** Like @c transaction_base::exec_params, but queued in the pipeline.  The
+   * parameters are converted to strings right away, so the arguments need
+   * not outlive this call.
+   *
+   * Parameterised queries and prepared statements go over the wire using the
+   * "extended query protocol," which does not allow several statements in one
+   * request.  Where libpq supports it (from PostgreSQL 14 on), the pipeline
+   * batches consecutive extended queries using libpq's own pipeline mode.
+   * Otherwise, it issues them one at a time.
+   *
+   * @return Identifier for this query, unique only within this pipeline.
+   */
+  template<typename... Args>
+  query_id insert_params(std::string_view query, Args &&... args)
+  {
+    return insert_query(
+      query_kind::params, query,
+      std::make_unique<internal::params>(std::forward<Args>(args)...));
+  }
+
+  /// Add execution of a prepared statement to the pipeline.
+  /** Like @c transaction_base::exec_prepared, but queued in the pipeline.
+   * See @c insert_params for how these queries get sent to the backend.
+   *
+   * @return Identifier for this query, unique only within this pipeline.
+   */
+  template<typename... Args>
+  query_id insert_prepared(std::string_view statement, Args &&... args)
+  {
+    return insert_query(
+      query_kind::prepared, statement,
+      std::make_unique<internal::params>(std::forward<Args>(args)...));
+  }
 
   /// Wait for all ongoing or pending operations to complete, and detach.
   /** Detaches from the transaction when done.
@@ -115,6 +207,36 @@ public:
    */
   void cancel();
 
+  /// Have a function called when the given query completes.
+  /** The pipeline calls the handler as the result comes in, at the end of any
+   * call which may receive results: @c insert(), @c complete(), @c flush(),
+   * @c retrieve(), @c resume(), or @c retain().  It passes the query's
+   * result, or if the query failed, the exception which @c retrieve() would
+   * have thrown.  After that, the result is gone from the pipeline; there is
+   * nothing to retrieve.
+   *
+   * The handler is not called if you @c retrieve() the query's result
+   * yourself, nor if the query gets cancelled or flushed before completing.
+   *
+   * If a handler throws an exception, that exception propagates out of the
+   * pipeline call which invoked it.  Handlers for any other finished queries
+   * will still be called, during the next pipeline call.
+   *
+   * Setting a new handler replaces any previous one for the same query.
+   */
+  void on_complete(query_id, completion_handler);
+
+  /// Get a future for the given query's result.
+  /** Sets a completion handler which fulfills the future.  The future only
+   * becomes ready during a pipeline call, so don't wait for it unless you
+   * know that something else will keep calling the pipeline in the meantime.
+   * Call @c complete() to make sure all futures get their results.
+   *
+   * If the query gets cancelled or flushed before completing, the future
+   * reports a broken promise.
+   */
+  std::future<result> get_future(query_id);
+
   /// Is result for given query available?
   [[nodiscard]] bool is_finished(query_id) const;
 
@@ -125,10 +247,7 @@ public:
    * than the one in which their queries were inserted, errors may "propagate"
    * to subsequent queries.
    */
-  result retrieve(query_id qid)
-  {
-    return retrieve(m_queries.find(qid)).second;
-  }
+  result retrieve(query_id qid) { return retrieve_query(qid).second; }
 
   /// Retrieve oldest unretrieved result (possibly wait for one).
   /** @return The query's identifier and its result set. */
@@ -151,31 +270,106 @@ public:
    */
   int retain(int retain_max = 2);
 
+  /// Let the pipeline choose its own retention capacity.
+  /** Instead of a fixed number, the pipeline measures the server round-trip
+   * time and the time per query from the batches it sends, and retains
+   * enough queries to keep the connection busy for about one round trip.
+   * A fast local server gets small batches; a distant one, larger ones.
+   *
+   * The timings are taken when the pipeline reads results, so they are most
+   * accurate if you retrieve results soon after they come in.
+   *
+   * Until a batch of more than one query has given it a time per query, the
+   * pipeline retains @c min_retain queries.
+   *
+   * Calling @c retain() switches adaptive mode off again.
+   *
+   * @param min_retain Never retain fewer queries than this.
+   * @param max_retain Never retain more queries than this.  This limits how
+   * much latency a large batch can add to the queries at its front.
+   */
+  void retain_adaptive(int min_retain = 0, int max_retain = 1000);
+
+  /// Current retention capacity, whether set manually or adaptively.
+  [[nodiscard]] int retain_limit() const noexcept { return m_retain; }
+
+  /// Timing of the most recent batch whose results all came in.
+  /** If no batch has completed yet, the stats are all zero.
+   */
+  [[nodiscard]] batch_stats last_batch() const noexcept
+  {
+    return m_last_batch;
+  }
+
 
   /// Resume retained query emission.  Harmless when not needed.
   void resume();
 
 private:
-  class PQXX_PRIVATE Query
+  friend class pqxx::internal::gate::pipeline_connection_multiplexer;
+  friend class pqxx::internal::gate::pipeline_parallel_executor;
+
+  /// How a query in the pipeline is to be executed.
+  enum class query_kind
   {
-  public:
-    explicit Query(std::string_view q) :
-            m_query{std::make_shared<std::string>(q)},
-            m_res{}
-    {}
+    /// Plain SQL text; consecutive ones can be batched into one string.
+    text,
+    /// Parameterised query, using the extended query protocol.
+    params,
+    /// Prepared statement; the text is the statement's name.
+    prepared,
+  };
 
-    result const &get_result() const noexcept { return m_res; }
-    void set_result(result const &r) noexcept { m_res = r; }
-    std::shared_ptr<std::string> get_query() const noexcept { return m_query; }
+  /// Entry in the pipeline's query table.
+  /** The query text itself lives in the pipeline's text arena.  Entries are
+   * never erased from the middle of the table; a retrieved entry is "retired"
+   * and stays in place until every older entry has been retired as well.
+   */
+  struct PQXX_PRIVATE Query
+  {
+    Query(
+      std::size_t begin, std::size_t size, query_kind k,
+      std::unique_ptr<internal::params> a) :
+            text_begin{begin},
+            text_size{size},
+            kind{k},
+            args{std::move(a)}
+    {}
 
-  private:
-    std::shared_ptr<std::string> m_query;
-    result m_res;
+    /// Offset of the query text in the text arena.
+    std::size_t text_begin;
+    /// Length of the query text, not including the trailing separator.
+    std::size_t text_size;
+    /// How to execute this query.
+    query_kind kind;
+    /// Parameters, for extended-protocol queries; null for plain text.
+    std::unique_ptr<internal::params> args;
+    /// The query's result, once it has come in.
+    result res;
+    /// Has this query's result been retrieved, or the query been cancelled?
+    bool retired = false;
+    /// Completion handler, if any.
+    completion_handler on_done;
   };
 
-  using QueryMap = std::map<query_id, Query>;
+  /// Queries, indexed by id relative to @c m_front_id.
+  using QueryTable = std::deque<Query>;
 
   void init();
+
+  /// Run each query in its own implicit transaction.
+  /** Normally, the queries in a batch share one implicit transaction on the
+   * server: if one fails, the ones before it in the batch get rolled back as
+   * well.  In isolated mode, the pipeline sends every query through the
+   * extended query protocol, with a sync after each.  A failing query then
+   * fails by itself, and the queries after it still run.
+   *
+   * Plain-text queries can contain only a single statement in this mode.
+   */
+  void isolate() noexcept { m_isolated = true; }
+
+  query_id insert_query(
+    query_kind, std::string_view text, std::unique_ptr<internal::params>);
   void attach();
   void detach();
 
@@ -192,6 +386,45 @@ private:
   /// Create new query_id
   PQXX_PRIVATE query_id generate_id();
 
+  /// The id that the next query to be inserted will get.
+  query_id end_id() const noexcept { return m_q_id + 1; }
+
+  /// Find a query which has not been retrieved yet, or nullptr.
+  PQXX_PRIVATE Query *find_query(query_id) noexcept;
+  PQXX_PRIVATE Query const *find_query(query_id) const noexcept;
+
+  /// Table entry for a query id which is known to be in the table.
+  Query &query_at(query_id qid) noexcept
+  {
+    return m_queries[static_cast<QueryTable::size_type>(qid - m_front_id)];
+  }
+
+  /// Text of a query in the table.
+  std::string_view text_of(Query const &q) const noexcept
+  {
+    return std::string_view{m_text.data() + q.text_begin, q.text_size};
+  }
+
+  /// Copy the texts of queries @c begin up to @c end into @c m_batch_texts.
+  PQXX_PRIVATE void share_texts(query_id begin, query_id end);
+
+  /// Shared text of a query in the batch in flight, for its result.
+  std::shared_ptr<std::string> batch_text(query_id qid) const noexcept
+  {
+    return std::shared_ptr<std::string>{
+      m_batch_texts,
+      &(*m_batch_texts)[static_cast<std::size_t>(qid - m_batch_first_id)]};
+  }
+
+  /// Mark query as retrieved, and drop whatever we no longer need.
+  PQXX_PRIVATE void retire(query_id) noexcept;
+
+  /// Discard all queries.
+  PQXX_PRIVATE void clear_queries() noexcept;
+
+  /// Call completion handlers for any queries that have finished.
+  PQXX_PRIVATE void dispatch();
+
   bool have_pending() const noexcept
   {
     return m_issuedrange.second != m_issuedrange.first;
@@ -218,12 +451,38 @@ private:
   /// Receive any results that happen to be available; it's not urgent
   PQXX_PRIVATE void receive_if_available();
 
+  /// Send extended-protocol queries [begin, end); return actual end.
+  PQXX_PRIVATE query_id issue_extended(query_id begin, query_id end);
+  /// Like obtain_result(), but for a batch sent in libpq pipeline mode.
+  PQXX_PRIVATE bool obtain_pipelined_result();
+  /// Read and discard what remains of a batch sent in libpq pipeline mode.
+  PQXX_PRIVATE void drain_pipelined_batch() noexcept;
+
   /// Receive results, up to stop if possible
-  PQXX_PRIVATE void receive(pipeline::QueryMap::const_iterator stop);
-  std::pair<pipeline::query_id, result> retrieve(pipeline::QueryMap::iterator);
+  PQXX_PRIVATE void receive(query_id stop);
+  std::pair<pipeline::query_id, result> retrieve_query(query_id);
+
+  /// Query table.  The oldest unretrieved query is always at the front.
+  QueryTable m_queries;
+
+  /// Id of the query at the front of @c m_queries.
+  query_id m_front_id = 1;
+
+  /// Arena holding the text of all queries in the table.
+  /** Each query is followed by a separator, so that a batch of consecutive
+   * queries forms one contiguous string.  The buffer is reused once the
+   * pipeline runs empty.
+   */
+  std::string m_text;
+
+  /// Texts of the queries in the batch in flight, from @c m_batch_first_id.
+  /** The batch's results all share this one allocation.
+   */
+  std::shared_ptr<std::vector<std::string>> m_batch_texts;
+  query_id m_batch_first_id = 0;
 
-  QueryMap m_queries;
-  std::pair<QueryMap::iterator, QueryMap::iterator> m_issuedrange;
+  /// Range of queries that have been issued, but whose results are not in.
+  std::pair<query_id, query_id> m_issuedrange;
   int m_retain = 0;
   int m_num_waiting = 0;
   query_id m_q_id = 0;
@@ -231,8 +490,50 @@ private:
   /// Is there a "dummy query" pending?
   bool m_dummy_pending = false;
 
+  /// Is the current batch running in libpq pipeline mode?
+  bool m_pipeline_mode = false;
+  /// Sync markers still to come in the current libpq pipeline batch.
+  int m_syncs_pending = 0;
+
+  /// Does each query get its own implicit transaction?
+  bool m_isolated = false;
+
+  /// Record the arrival of a result for the current batch.
+  PQXX_PRIVATE void note_result() noexcept;
+
+  /// Choose retention capacity by measuring performance?
+  bool m_adaptive = false;
+  int m_min_retain = 0;
+  int m_max_retain = 0;
+
+  /// When the current batch was sent.
+  std::chrono::steady_clock::time_point m_batch_start;
+  /// When the current batch's first result came in, if it has.
+  std::chrono::steady_clock::time_point m_batch_first;
+  /// Number of queries in the current batch; zero if not measuring.
+  int m_batch_queries = 0;
+  /// Has the current batch's first result come in?
+  bool m_batch_started = false;
+  batch_stats m_last_batch;
+
+  /// Smoothed estimate of the round-trip time, in seconds.
+  double m_round_trip = 0;
+  /// Smoothed estimate of the backend's time per query, in seconds.
+  double m_per_query = 0;
+  /// Have we measured @c m_round_trip yet?
+  bool m_have_round_trip = false;
+  /// Have we measured @c m_per_query yet?  Only a multi-query batch can.
+  bool m_have_per_query = false;
+
   /// Point at which an error occurred; no results beyond it will be available
   query_id m_error = qid_limit();
+
+  /// Number of queries in the table that have completion handlers.
+  int m_num_handlers = 0;
+  /// Oldest query which may still need its completion handler called.
+  query_id m_dispatch_from = 1;
+  /// Are we currently calling completion handlers?
+  bool m_dispatching = false;
 };
 } // namespace pqxx
 
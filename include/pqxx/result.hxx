@@ -19,6 +19,7 @@
 #include <ios>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include "pqxx/except.hxx"
 #include "pqxx/types.hxx"
@@ -40,7 +41,9 @@ class result_connection;
 class result_creation;
 class result_pipeline;
 class result_row;
+class result_shard_router;
 class result_sql_cursor;
+class result_transaction;
 } // namespace pqxx::internal::gate
 
 
@@ -161,6 +164,9 @@ public:
     return column_type(column_number(col_name));
   }
 
+  /// Return the format in which the column's data came in.
+  [[nodiscard]] format column_format(row_size_type col_num) const noexcept;
+
   /// What table did this column come from?
   [[nodiscard]] oid column_table(row_size_type col_num) const;
 
@@ -249,7 +255,14 @@ private:
   PQXX_PRIVATE std::string StatusError() const;
 
   friend class pqxx::internal::gate::result_sql_cursor;
+  friend class pqxx::internal::gate::result_transaction;
   PQXX_PURE char const *cmd_status() const noexcept;
+  /// Copy rows [begin, end) into a new result with the same columns.
+  result copy_rows(size_type begin, size_type end) const;
+
+  friend class pqxx::internal::gate::result_shard_router;
+  /// Concatenate the rows of results with the same column names and types.
+  static result concat(std::vector<result> const &parts);
 };
 } // namespace pqxx
 
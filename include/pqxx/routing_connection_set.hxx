@@ -0,0 +1,133 @@
+/* Route reads to replicas, and writes to the primary.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/routing_connection_set
+ * instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_ROUTING_CONNECTION_SET
+#define PQXX_H_ROUTING_CONNECTION_SET
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "pqxx/connection_pool.hxx"
+
+
+namespace pqxx
+{
+/// Connection pools for a primary server and its read replicas.
+/** Use @c write() to get a connection to the primary, for anything that may
+ * write.  Use @c read() to get a connection for a @c read_transaction or a
+ * reading @c nontransaction: it goes to whichever healthy replica has the
+ * fewest connections in use, or to the primary if no replica is available.
+ *
+ * A replica that fails to connect counts as unhealthy for a while.  After
+ * that it gets another chance.
+ *
+ * Replicas lag behind the primary.  If you need to read your own writes, get
+ * the primary's WAL position after you commit, using @c wal_position(), and
+ * pass it to @c read().  It will then only pick a replica that has replayed
+ * at least that far, waiting for one to catch up if needed.  If none does
+ * in time, it falls back to the primary.
+ *
+ * This class is thread-safe, but the connections it hands out are not: each
+ * is for the one thread that holds its lease.
+ */
+class PQXX_LIBEXPORT routing_connection_set
+{
+public:
+  /**
+   * @param primary Connection string for the primary server.
+   * @param replicas Connection strings for the read replicas.
+   * @param pool_size Maximum number of connections per server.
+   */
+  routing_connection_set(
+    std::string primary, std::vector<std::string> const &replicas,
+    std::size_t pool_size = 8);
+
+  routing_connection_set(routing_connection_set const &) = delete;
+  routing_connection_set &operator=(routing_connection_set const &) = delete;
+  ~routing_connection_set() noexcept;
+
+  /// Get a connection to the primary.
+  [[nodiscard]] connection_pool::lease write() { return m_primary.acquire(); }
+
+  /// Get a connection for reading: a replica if possible.
+  /** This does not wait for a busy replica.  If every healthy replica's
+   * connections are all in use, it goes to the primary.
+   */
+  [[nodiscard]] connection_pool::lease read();
+
+  /// Get a connection for reading data as of WAL position @c lsn or later.
+  /** Waits up to @c timeout for a replica to catch up, then falls back to the
+   * primary.
+   *
+   * @param lsn A WAL position, as returned by @c wal_position().
+   * @param timeout How long to wait for a replica to replay up to @c lsn.
+   */
+  [[nodiscard]] connection_pool::lease
+  read(std::string const &lsn, std::chrono::milliseconds timeout);
+
+  /// Current WAL position on the primary, for use with @c read().
+  /** Call this after you commit your writes.  It takes a connection to the
+   * primary, which must not have a transaction open.
+   */
+  [[nodiscard]] static std::string wal_position(connection &primary);
+
+  /// How long a replica that failed to connect gets skipped.
+  void set_retry_interval(std::chrono::milliseconds interval);
+
+  /// The primary's pool.
+  [[nodiscard]] connection_pool &primary() noexcept { return m_primary; }
+
+  /// Number of replicas.
+  [[nodiscard]] std::size_t replicas() const noexcept
+  {
+    return m_replicas.size();
+  }
+
+  /// Is replica number @c n currently considered healthy?
+  [[nodiscard]] bool healthy(std::size_t n) const;
+
+private:
+  using clock = std::chrono::steady_clock;
+
+  struct replica
+  {
+    explicit replica(std::string const &options, std::size_t pool_size) :
+            pool{options, pool_size}
+    {}
+    connection_pool pool;
+    /// Don't try this replica again until this time.
+    clock::time_point down_until;
+  };
+
+  /// Healthy replicas, least-loaded first.
+  std::vector<replica *> candidates() const;
+  /// Try to get a connection to @c r, without waiting for one.
+  /** Returns an empty lease if all of @c r's connections are in use, or if
+   * connecting failed.  In the latter case, marks @c r down.
+   */
+  connection_pool::lease try_replica(replica &r);
+
+  connection_pool m_primary;
+  std::vector<std::unique_ptr<replica>> m_replicas;
+  /// Protects the replicas' health information, and the retry interval.
+  mutable std::mutex m_mutex;
+  std::chrono::milliseconds m_retry_interval{5000};
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
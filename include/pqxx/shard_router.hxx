@@ -0,0 +1,203 @@
+/* Client-side routing of keys to sharded databases.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/shard_router instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_SHARD_ROUTER
+#define PQXX_H_SHARD_ROUTER
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pqxx/connection_pool.hxx"
+#include "pqxx/except.hxx"
+#include "pqxx/result.hxx"
+#include "pqxx/strconv.hxx"
+#include "pqxx/transaction_base.hxx"
+
+
+namespace pqxx
+{
+/// Connection pools for a set of sharded databases.
+/** Data is spread over several databases, or "shards," by some key.  A
+ * shard function maps each key to the number of the shard that holds it.
+ * Use @c hash_shards() to spread keys evenly, or @c range_shards() to
+ * split them into ranges.  Or write your own.
+ *
+ * Each shard gets its own @c connection_pool.  Use @c acquire() to get a
+ * connection to the shard for a given key.
+ *
+ * For queries that need all shards, @c for_each_shard() and the
+ * @c scatter() functions run a query on every shard in parallel, each in
+ * its own thread and in autocommit mode, as in a @c nontransaction.  The
+ * scatter functions merge the results into one, in shard order.
+ *
+ * A statement that you @c prepare() through the router gets prepared on
+ * every connection to every shard, as the connection is leased out.
+ *
+ * This class is thread-safe, but the connections it hands out are not: each
+ * is for the one thread that holds its lease.
+ */
+class PQXX_LIBEXPORT shard_router
+{
+public:
+  /// Function mapping a key, in its text form, to a shard number.
+  using shard_function = std::function<std::size_t(std::string_view)>;
+
+  /// Query to run on one shard: gets a transaction, and the shard number.
+  using shard_task = std::function<result(transaction_base &, std::size_t)>;
+
+  /**
+   * @param shards Connection strings for the shards, in shard order.
+   * @param shard_of Shard function.  Defaults to @c hash_shards().
+   * @param pool_size Maximum number of connections per shard.
+   */
+  explicit shard_router(
+    std::vector<std::string> const &shards, shard_function shard_of = {},
+    std::size_t pool_size = 4);
+
+  shard_router(shard_router const &) = delete;
+  shard_router &operator=(shard_router const &) = delete;
+  ~shard_router() noexcept;
+
+  /// Shard function which spreads keys evenly across @c n shards.
+  /** This uses a "jump consistent hash."  The result for any given key is
+   * the same on every platform, and if you go from @c n to @c n+1 shards,
+   * only about 1 in @c n+1 keys move to a different shard.
+   */
+  static shard_function hash_shards(std::size_t n);
+
+  /// Shard function which assigns keys to shards by range.
+  /** A key that is less than @c bounds[0] goes to shard 0.  A key that is
+   * at least @c bounds[i-1] but less than @c bounds[i] goes to shard @c i.
+   * Any other key goes to the last shard, so this makes for
+   * @c bounds.size()+1 shards.
+   *
+   * Keys are converted to @c T using @c from_string.
+   */
+  template<typename T>
+  static shard_function range_shards(std::vector<T> bounds)
+  {
+    if (not std::is_sorted(std::begin(bounds), std::end(bounds)))
+      throw argument_error{"Shard range bounds are not in ascending order."};
+    return [bounds = std::move(bounds)](std::string_view key) {
+      auto const k{from_string<T>(key)};
+      return static_cast<std::size_t>(
+        std::upper_bound(std::begin(bounds), std::end(bounds), k) -
+        std::begin(bounds));
+    };
+  }
+
+  /// Number of shards.
+  [[nodiscard]] std::size_t size() const noexcept { return std::size(m_pools); }
+
+  /// Which shard holds @c key?
+  template<typename KEY>[[nodiscard]] std::size_t shard_of(KEY const &key) const
+  {
+    return pick(to_string(key));
+  }
+
+  /// The connection pool for shard number @c n.
+  [[nodiscard]] connection_pool &shard(std::size_t n);
+
+  /// Lease a connection to the shard that holds @c key.
+  template<typename KEY>
+  [[nodiscard]] connection_pool::lease acquire(
+    KEY const &key,
+    connection_pool::priority p = connection_pool::priority::normal)
+  {
+    return shard(shard_of(key)).acquire(p);
+  }
+
+  /// Prepare a statement on all connections to all shards.
+  void prepare(std::string const &name, std::string const &definition);
+
+  /// Run @c task on every shard in parallel.
+  /** Returns the results in shard order.  If any of the tasks fails, this
+   * waits for the others to finish, and then re-throws the first shard's
+   * error.
+   */
+  std::vector<result> for_each_shard(
+    shard_task const &task,
+    connection_pool::priority p = connection_pool::priority::normal);
+
+  /// Run a query on every shard in parallel, and merge the results.
+  result scatter(
+    std::string const &query,
+    connection_pool::priority p = connection_pool::priority::normal)
+  {
+    return merge(for_each_shard(
+      [&query](transaction_base &tx, std::size_t) { return tx.exec(query); },
+      p));
+  }
+
+  /// Run a parameterised query on every shard, and merge the results.
+  template<typename... Args>
+  result scatter_params(std::string const &query, Args &&... args)
+  {
+    return scatter_params(
+      connection_pool::priority::normal, query, std::forward<Args>(args)...);
+  }
+
+  /// Run a parameterised query on every shard, at priority @c p.
+  template<typename... Args>
+  result scatter_params(
+    connection_pool::priority p, std::string const &query, Args &&... args)
+  {
+    return merge(for_each_shard(
+      [&](transaction_base &tx, std::size_t) {
+        return tx.exec_params(query, args...);
+      },
+      p));
+  }
+
+  /// Run a prepared statement on every shard, and merge the results.
+  template<typename... Args>
+  result scatter_prepared(std::string const &statement, Args &&... args)
+  {
+    return scatter_prepared(
+      connection_pool::priority::normal, statement,
+      std::forward<Args>(args)...);
+  }
+
+  /// Run a prepared statement on every shard, at priority @c p.
+  template<typename... Args>
+  result scatter_prepared(
+    connection_pool::priority p, std::string const &statement,
+    Args &&... args)
+  {
+    return merge(for_each_shard(
+      [&](transaction_base &tx, std::size_t) {
+        return tx.exec_prepared(statement, args...);
+      },
+      p));
+  }
+
+  /// Concatenate results which have the same columns.
+  /** @throw argument_error if the results' column names or types differ.
+   */
+  static result merge(std::vector<result> const &parts);
+
+private:
+  /// Apply the shard function, and check its answer.
+  std::size_t pick(std::string_view key) const;
+
+  std::vector<std::unique_ptr<connection_pool>> m_pools;
+  shard_function m_shard_of;
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
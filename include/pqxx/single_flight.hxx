@@ -0,0 +1,123 @@
+/* Share one execution between identical concurrent queries.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/single_flight instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_SINGLE_FLIGHT
+#define PQXX_H_SINGLE_FLIGHT
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "pqxx/connection_pool.hxx"
+#include "pqxx/internal/statement_parameters.hxx"
+#include "pqxx/result.hxx"
+#include "pqxx/transaction_base.hxx"
+
+
+namespace pqxx
+{
+/// Coalesce identical read queries that are running at the same time.
+/** When many threads issue the exact same query at the same moment, they
+ * often all want the same answer.  A single_flight lets one of them run the
+ * query, on a connection from a @c connection_pool.  The others wait for it,
+ * and get the same @c result.  (Copying a result is cheap: the copies share
+ * the same underlying data.)
+ *
+ * Queries are "identical" if they are the same kind (plain, parameterised,
+ * or prepared), with the same text or statement name, and with the same
+ * parameter values.  There is no caching: as soon as a query completes, the
+ * next identical one goes to the server again.
+ *
+ * If the query fails, every thread waiting for it gets the same exception.
+ *
+ * Queries run in autocommit mode, as in a @c nontransaction.  Only use this
+ * for queries that just read: a write would happen only once, no matter how
+ * many threads asked for it.  A prepared statement must be prepared on each
+ * connection in the pool.
+ *
+ * This class is thread-safe.
+ */
+class PQXX_LIBEXPORT single_flight
+{
+public:
+  explicit single_flight(connection_pool &pool);
+
+  single_flight(single_flight const &) = delete;
+  single_flight &operator=(single_flight const &) = delete;
+  ~single_flight() noexcept;
+
+  /// Run a query, or wait for an identical one that's already running.
+  result exec(std::string const &query)
+  {
+    return coalesce(
+      make_key('Q', query, internal::params{}),
+      [&query](transaction_base &tx) { return tx.exec(query); });
+  }
+
+  /// Run a parameterised query, or share an identical one's result.
+  template<typename... Args>
+  result exec_params(std::string const &query, Args &&... args)
+  {
+    return coalesce(
+      make_key('P', query, internal::params{args...}),
+      [&](transaction_base &tx) {
+        return tx.exec_params(query, std::forward<Args>(args)...);
+      });
+  }
+
+  /// Run a prepared statement, or share an identical one's result.
+  template<typename... Args>
+  result exec_prepared(std::string const &statement, Args &&... args)
+  {
+    return coalesce(
+      make_key('S', statement, internal::params{args...}),
+      [&](transaction_base &tx) {
+        return tx.exec_prepared(statement, std::forward<Args>(args)...);
+      });
+  }
+
+  /// Number of queries that actually went to the server.
+  [[nodiscard]] std::size_t executions() const noexcept
+  {
+    return m_executions.load(std::memory_order_relaxed);
+  }
+
+  /// Number of queries that shared another one's execution.
+  [[nodiscard]] std::size_t coalesced() const noexcept
+  {
+    return m_coalesced.load(std::memory_order_relaxed);
+  }
+
+private:
+  /// Identify a query by its kind, text, and parameter values.
+  static std::string
+  make_key(char kind, std::string_view text, internal::params const &args);
+
+  result coalesce(
+    std::string &&key, std::function<result(transaction_base &)> const &run);
+
+  connection_pool &m_pool;
+  std::mutex m_mutex;
+  /// Queries currently running, by key.
+  std::unordered_map<std::string, std::shared_future<result>> m_in_flight;
+  std::atomic<std::size_t> m_executions{0};
+  std::atomic<std::size_t> m_coalesced{0};
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
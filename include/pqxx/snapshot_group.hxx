@@ -0,0 +1,106 @@
+/* Transactions on several connections, sharing one snapshot.
+ *
+ * DO NOT INCLUDE THIS FILE DIRECTLY; include pqxx/snapshot_group instead.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#ifndef PQXX_H_SNAPSHOT_GROUP
+#define PQXX_H_SNAPSHOT_GROUP
+
+#include "pqxx/compiler-public.hxx"
+#include "pqxx/internal/compiler-internal-pre.hxx"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pqxx/transaction.hxx"
+
+
+namespace pqxx
+{
+/// Transactions on several connections, all seeing the same snapshot.
+/** Use this to read one consistent state of the database in parallel, e.g.
+ * with a @c stream_from or cursor per thread.
+ *
+ * The group starts a "leader" transaction on one connection, and exports
+ * its snapshot.  Each time you call @c join(), it starts a read-only
+ * "follower" transaction on another connection, which imports that
+ * snapshot.  All of these transactions see exactly the same data, as of the
+ * moment the leader exported its snapshot.
+ *
+ * Importing a snapshot requires a repeatable-read or serialisable
+ * transaction, so that's what the leader and followers are.  The leader can
+ * write; the followers can only read.
+ *
+ * The group owns its transactions.  Followers can only join while the leader
+ * is open.  Destroying the group aborts any transactions that haven't been
+ * committed, followers first.  Each transaction can be used from its own
+ * thread, but the group itself is not thread-safe: create the group and call
+ * @c join() from one thread.
+ */
+class PQXX_LIBEXPORT snapshot_group
+{
+public:
+  using leader_type = transaction<isolation_level::repeatable_read>;
+  using follower_type =
+    transaction<isolation_level::repeatable_read, write_policy::read_only>;
+
+  /// Start the leader transaction on @c c, and export its snapshot.
+  explicit snapshot_group(connection &c);
+
+  snapshot_group(snapshot_group const &) = delete;
+  snapshot_group &operator=(snapshot_group const &) = delete;
+  ~snapshot_group() noexcept;
+
+  /// Start a follower transaction on @c c, using the leader's snapshot.
+  /** The connection must be to the same database as the leader's, and it
+   * must not have a transaction open.
+   */
+  follower_type &join(connection &c);
+
+  /// The leader transaction.
+  [[nodiscard]] leader_type &leader() noexcept { return *m_leader; }
+
+  /// Follower transaction number @c n, counting from zero.
+  [[nodiscard]] follower_type &follower(std::size_t n)
+  {
+    return *m_followers.at(n);
+  }
+
+  /// Number of followers.
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return m_followers.size();
+  }
+
+  /// The exported snapshot's identifier, as used in SET TRANSACTION SNAPSHOT.
+  [[nodiscard]] std::string const &snapshot_id() const noexcept
+  {
+    return m_snapshot;
+  }
+
+  /// Commit the followers, then the leader.
+  /** After this, no more followers can join.
+   */
+  void commit();
+
+  /// Abort the followers and the leader.
+  void abort() noexcept;
+
+private:
+  /// Is the leader still open?
+  bool m_open = true;
+  std::unique_ptr<leader_type> m_leader;
+  std::string m_snapshot;
+  /// Declared after the leader, so they get destroyed first.
+  std::vector<std::unique_ptr<follower_type>> m_followers;
+};
+} // namespace pqxx
+
+#include "pqxx/internal/compiler-internal-post.hxx"
+#endif
@@ -63,6 +63,10 @@ namespace pqxx
  * (This is just an example.  If you really wanted to do drop a table without
  * an error if it doesn't exist, you'd use DROP TABLE IF EXISTS.)
  *
+ * Committing a subtransaction does not cost a round trip of its own: the
+ * RELEASE SAVEPOINT goes out along with the next statement.  If the enclosing
+ * transaction ends before that, it isn't needed at all.
+ *
  * There are no isolation levels inside a transaction.  They are not needed
  * because all actions within the same backend transaction are always performed
  * sequentially anyway.
@@ -72,19 +76,33 @@ class PQXX_LIBEXPORT subtransaction : public internal::transactionfocus,
 {
 public:
   /// Nest a subtransaction nested in another transaction.
+  /** With @c begin_policy::lazy, the savepoint goes out along with the
+   * subtransaction's first statement.
+   */
   explicit subtransaction(
-    dbtransaction &t, std::string const &name = std::string{});
+    dbtransaction &t, std::string const &name = std::string{},
+    begin_policy policy = begin_policy::eager);
 
   /// Nest a subtransaction in another subtransaction.
   explicit subtransaction(
-    subtransaction &t, std::string const &name = std::string{});
+    subtransaction &t, std::string const &name = std::string{},
+    begin_policy policy = begin_policy::eager);
 
   virtual ~subtransaction() noexcept override { close(); }
 
 private:
-  std::string quoted_name() const { return quote_name(name()); }
   virtual void do_commit() override;
   virtual void do_abort() override;
+
+  /// Nesting depth for a subtransaction inside @c parent.
+  static std::size_t nesting_depth(dbtransaction const &parent) noexcept;
+
+  /// Savepoint name, quoted and escaped.  Built once, used several times.
+  std::string const m_quoted_name;
+  /// The SAVEPOINT command; it may still be deferred.
+  std::string const m_savepoint;
+  /// Nesting depth.  One directly inside a transaction is at depth 1.
+  std::size_t const m_depth;
 };
 } // namespace pqxx
 
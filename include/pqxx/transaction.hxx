@@ -23,11 +23,16 @@ namespace pqxx::internal
 class PQXX_LIBEXPORT basic_transaction : public dbtransaction
 {
 protected:
-  basic_transaction(connection &c, char const begin_command[]);
+  basic_transaction(
+    connection &c, char const begin_command[],
+    begin_policy policy = begin_policy::eager);
 
 private:
   virtual void do_commit() override;
   virtual void do_abort() override;
+
+  /// The command that starts the transaction; it may still be deferred.
+  char const *const m_begin_command;
 };
 } // namespace pqxx::internal
 
@@ -71,15 +76,22 @@ public:
    * @param c Connection for this transaction to operate on.
    * @param tname Optional name for transaction.  Must begin with a letter and
    * may contain letters and digits only.
+   * @param policy Start the transaction right away, or along with its first
+   * statement.  See @c begin_policy.
    */
-  explicit transaction(connection &c, std::string const &tname) :
+  explicit transaction(
+    connection &c, std::string const &tname,
+    begin_policy policy = begin_policy::eager) :
           namedclass{"transaction", tname},
           internal::basic_transaction(
-            c, internal::begin_cmd<ISOLATION, READWRITE>.c_str())
+            c, internal::begin_cmd<ISOLATION, READWRITE>.c_str(), policy)
   {}
 
   explicit transaction(connection &c) : transaction(c, "") {}
 
+  transaction(connection &c, begin_policy policy) : transaction(c, "", policy)
+  {}
+
   virtual ~transaction() noexcept override { close(); }
 };
 
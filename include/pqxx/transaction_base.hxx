@@ -125,6 +125,34 @@ public:
    */
   void abort();
 
+  /// Queue statements whose results you don't need, and send them in bulk.
+  /** In write-behind mode, @c exec0(), @c exec_params0(), and
+   * @c exec_prepared0() don't execute their statements right away.  They
+   * queue them, and return an empty result.  The queued statements go out
+   * in one batch, pipelined with the next statement that does need a result,
+   * or with the commit.  So a chain of N such statements followed by a
+   * commit takes one round trip, not N + 1.
+   *
+   * If a queued statement fails, or returns rows, the error surfaces at the
+   * point where the batch goes out: the exception is that statement's own,
+   * with that statement's query text.  Statements after it do not execute.
+   * Aborting the transaction discards any statements that are still queued.
+   *
+   * With libpq's pipeline mode (PostgreSQL 14 and up), each queued statement
+   * must be a single SQL statement.  Without pipeline mode, the statements
+   * still get queued, but go out one by one.
+   *
+   * A @c nontransaction can't use write-behind mode: a batch would run as a
+   * single implicit transaction, so a failing statement would roll back
+   * earlier ones that had already succeeded.
+   *
+   * @throw usage_error if this is not a real database transaction.
+   */
+  void set_write_behind(bool on);
+
+  /// Is this transaction in write-behind mode?  See @c set_write_behind().
+  [[nodiscard]] bool write_behind() const noexcept { return m_write_behind; }
+
   /**
    * @ingroup escaping-functions
    */
@@ -250,6 +278,8 @@ public:
   result
   exec0(std::string const &query, std::string const &desc = std::string{})
   {
+    if (m_write_behind)
+      return queue_write_behind(query, internal::params{}, false);
     return exec_n(0, query, desc);
   }
 
@@ -339,6 +369,9 @@ public:
   template<typename... Args>
   result exec_params0(std::string const &query, Args &&... args)
   {
+    if (m_write_behind)
+      return queue_write_behind(
+        query, internal::params(std::forward<Args>(args)...), false);
     return exec_params_n(0, query, std::forward<Args>(args)...);
   }
 
@@ -419,12 +452,19 @@ public:
   template<typename... Args>
   result exec_prepared0(std::string const &statement, Args &&... args)
   {
+    if (m_write_behind)
+      return queue_write_behind(
+        statement, internal::params(std::forward<Args>(args)...), true);
     return exec_prepared_n(0, statement, std::forward<Args>(args)...);
   }
 
   template<typename... Args>
   result exec_prepared0(zview statement, Args &&... args)
   {
+    if (m_write_behind)
+      return queue_write_behind(
+        std::string{statement}, internal::params(std::forward<Args>(args)...),
+        true);
     return exec_prepared_n(0, statement, std::forward<Args>(args)...);
   }
 
@@ -511,6 +551,29 @@ protected:
   result direct_exec(std::string_view);
   result direct_exec(std::shared_ptr<std::string>);
 
+  /// Send command along with the next statement on the connection.
+  void defer(std::string command);
+  /// Take back a deferred command, if it hasn't been sent yet.
+  bool cancel_deferred(std::string_view command) noexcept;
+  /// Drop all deferred statements of this transaction, which is aborting.
+  /** @param command The command that started this transaction.
+   * @return Whether @c command was still queued.  If so, there's nothing to
+   * roll back.
+   */
+  bool discard_deferred(std::string_view command = {}) noexcept;
+  /// Send RELEASE SAVEPOINT command along with the next statement, if any.
+  /** @param depth Nesting depth of the savepoint.  Top level is 0.
+   */
+  void defer_release(std::shared_ptr<std::string> command, std::size_t depth);
+  /// Forget deferred RELEASEs nested inside this transaction.
+  /** Ending a transaction at nesting depth @c depth makes the RELEASEs of
+   * savepoints nested deeper than that redundant.  Returns whether there
+   * were any.
+   */
+  bool drop_deferred_releases(std::size_t depth) noexcept;
+  /// Execute single-statement command, along with any queued statements.
+  result direct_exec_single(std::shared_ptr<std::string>);
+
 private:
   enum class status
   {
@@ -523,6 +586,13 @@ private:
 
   PQXX_PRIVATE void check_pending_error();
 
+  /// Check that we can execute a query now.
+  PQXX_PRIVATE void check_exec(std::string const &desc);
+
+  /// Queue a write-behind statement.  Returns an empty result.
+  result queue_write_behind(
+    std::string const &query, internal::params &&args, bool prepared);
+
   template<typename T> bool parm_is_null(T *p) const noexcept
   {
     return p == nullptr;
@@ -552,6 +622,7 @@ private:
   internal::unique<internal::transactionfocus> m_focus;
   status m_status = status::active;
   bool m_registered = false;
+  bool m_write_behind = false;
   std::string m_pending_error;
 };
 } // namespace pqxx
@@ -14,6 +14,8 @@
 #include "pqxx/compiler-public.hxx"
 #include "pqxx/internal/compiler-internal-pre.hxx"
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <type_traits>
 
@@ -141,6 +143,145 @@ inline auto perform(TRANSACTION_CALLBACK &&callback, int attempts = 3)
   }
   throw pqxx::internal_error{"No outcome reached on perform()."};
 }
+
+
+/// Rules for retrying a transaction, and statistics on how that went.
+/** Pass one of these to @c perform to control how it retries your callback:
+ * how many attempts it makes, and how long it waits between them.  The wait
+ * grows exponentially with each failed attempt, with some randomness thrown
+ * in.  When many clients keep running into the same conflicts, waiting helps
+ * them get out of each other's way.  If they retried right away, they might
+ * just keep colliding.
+ *
+ * The policy decides what to retry based on the error's SQLSTATE.  It
+ * considers serialization failures (40001), deadlocks (40P01), and failures to
+ * obtain a lock (55P03) to be conflicts between transactions.  Other
+ * transaction rollbacks, and broken connections, are also worth a retry.  It
+ * does not retry any other errors.
+ *
+ * The policy also keeps count of the attempts it made and the conflicts it
+ * saw.  If you use a separate policy object for each of your callbacks, this
+ * will tell you which ones run into contention, e.g. on hot rows.  The
+ * counters are atomic, so you can share a policy between threads.
+ */
+class PQXX_LIBEXPORT retry_policy
+{
+public:
+  /// How should we treat a given failure?
+  enum class failure_kind
+  {
+    /// Don't retry.
+    fatal,
+    /// Conflict with other transactions: serialization failure, deadlock, or
+    /// failure to get a lock.
+    conflict,
+    /// Other transaction rollback.
+    rollback,
+    /// Lost connection.
+    broken_connection,
+  };
+
+  /**
+   * @param attempts Maximum number of times to attempt performing callback.
+   *	Must be greater than zero.
+   * @param initial_delay Time to wait after the first failure.  The wait
+   *	doubles with each subsequent failure.
+   * @param max_delay Upper limit to the wait between attempts.
+   */
+  explicit retry_policy(
+    int attempts = 3,
+    std::chrono::milliseconds initial_delay = std::chrono::milliseconds{10},
+    std::chrono::milliseconds max_delay = std::chrono::milliseconds{1000});
+
+  /// Set a function to call when a connection breaks, before retrying.
+  /** Use this to re-establish a connection which your callback uses, if your
+   * callback does not create its own.  If the hook throws an exception,
+   * @c perform passes it on to you, and gives up.
+   */
+  void set_reconnect(std::function<void()> hook)
+  {
+    m_reconnect = std::move(hook);
+  }
+
+  /// Maximum number of attempts.
+  [[nodiscard]] int attempts() const noexcept { return m_attempts; }
+
+  /// Number of times @c perform has called a callback with this policy.
+  [[nodiscard]] long tries() const noexcept { return m_tries.load(); }
+
+  /// Number of conflicts that attempts with this policy have run into.
+  [[nodiscard]] long conflicts() const noexcept { return m_conflicts.load(); }
+
+  /// Reset the counters to zero.
+  void reset_counters() noexcept
+  {
+    m_tries = 0;
+    m_conflicts = 0;
+  }
+
+  /// How should we treat this error?
+  [[nodiscard]] static failure_kind classify(sql_error const &) noexcept;
+
+  /// For use by @c perform: register a new attempt.
+  void count_try() noexcept { ++m_tries; }
+
+  /// For use by @c perform: handle a failure, and say whether to retry.
+  /** If the answer is yes, this also waits for the appropriate time.
+   *
+   * @param kind The kind of failure that happened.
+   * @param attempt The number of the failed attempt, starting at 1.
+   */
+  bool retry(failure_kind kind, int attempt);
+
+private:
+  int const m_attempts;
+  std::chrono::milliseconds const m_initial_delay, m_max_delay;
+  std::function<void()> m_reconnect;
+  std::atomic<long> m_tries{0}, m_conflicts{0};
+};
+
+
+/// Execute a transaction with automatic retry, according to a policy.
+/** Works like the other @c perform, but the @c retry_policy decides which
+ * errors are worth a retry, how many attempts to make, and how long to wait
+ * between them.  The policy also keeps statistics.
+ */
+template<typename TRANSACTION_CALLBACK>
+inline auto perform(TRANSACTION_CALLBACK &&callback, retry_policy &policy)
+  -> std::invoke_result_t<TRANSACTION_CALLBACK>
+{
+  for (int attempt{1};; ++attempt)
+  {
+    policy.count_try();
+    try
+    {
+      return std::invoke(callback);
+    }
+    catch (in_doubt_error const &)
+    {
+      // Not sure whether transaction went through or not.  The last thing in
+      // the world that we should do now is try again!
+      throw;
+    }
+    catch (statement_completion_unknown const &)
+    {
+      // Not sure whether our last statement succeeded.  Don't risk running it
+      // again.
+      throw;
+    }
+    catch (broken_connection const &)
+    {
+      if (not policy.retry(
+            retry_policy::failure_kind::broken_connection, attempt))
+        throw;
+    }
+    catch (sql_error const &e)
+    {
+      if (not policy.retry(retry_policy::classify(e), attempt))
+        throw;
+    }
+  }
+}
 } // namespace pqxx
 //@}
 
@@ -32,6 +32,13 @@ using field_size_type = size_t;
 /// Number of bytes in a large object.
 using large_object_size_type = int64_t;
 
+/// Format in which the backend sends a column's data: text or binary.
+enum class format : int
+{
+  text = 0,
+  binary = 1,
+};
+
 
 // Forward declarations, to help break compilation dependencies.
 // These won't necessarily include all classes in libpqxx.
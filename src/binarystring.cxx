@@ -42,6 +42,14 @@ std::shared_ptr<unsigned char> copy_to_buffer(void const *data, size_t len)
 
 pqxx::binarystring::binarystring(field const &F)
 {
+  if (F.is_binary())
+  {
+    // Raw bytes, e.g. from a binary cursor.  Nothing to unescape.
+    m_size = F.size();
+    m_buf = copy_to_buffer(F.c_str(), m_size);
+    return;
+  }
+
   unsigned char const *data{
     reinterpret_cast<unsigned char const *>(F.c_str())};
   m_buf =
@@ -566,12 +566,265 @@ pqxx::result pqxx::connection::exec(std::string_view query)
 
 pqxx::result pqxx::connection::exec(std::shared_ptr<std::string> query)
 {
+  // Write-behind statements need their own results, to report errors.
+  if (has_write_behind())
+    flush_deferred();
+
+  if (not m_deferred.empty())
+  {
+    // Send the deferred commands and the query as a single multi-statement
+    // query.  We get the last statement's result.
+    std::string text;
+    for (auto const &command : m_deferred) (text += *command.query) += "; ";
+    text += *query;
+    m_deferred.clear();
+    auto const res{make_result(PQexec(m_conn, text.c_str()), query)};
+    get_notifs();
+    return res;
+  }
+
   auto const res{make_result(PQexec(m_conn, query->c_str()), query)};
   get_notifs();
   return res;
 }
 
 
+void pqxx::connection::defer(std::string command)
+{
+  m_deferred.push_back(
+    internal::queued_statement{std::make_shared<std::string>(command)});
+}
+
+
+void pqxx::connection::defer_release(
+  std::shared_ptr<std::string> command, std::size_t depth)
+{
+  internal::queued_statement s{std::move(command)};
+  s.release = true;
+  s.depth = depth;
+  m_deferred.push_back(std::move(s));
+}
+
+
+bool pqxx::connection::drop_deferred_releases(std::size_t depth) noexcept
+{
+  auto const end{std::remove_if(
+    std::begin(m_deferred), std::end(m_deferred),
+    [depth](internal::queued_statement const &s) {
+      return s.release and s.depth > depth;
+    })};
+  bool const dropped{end != std::end(m_deferred)};
+  m_deferred.erase(end, std::end(m_deferred));
+  return dropped;
+}
+
+
+void pqxx::connection::write_behind(
+  std::shared_ptr<std::string> query, internal::params &&args, bool prepared)
+{
+  m_deferred.push_back(internal::queued_statement{
+    std::move(query), std::move(args), prepared, true});
+}
+
+
+bool pqxx::connection::cancel_deferred(std::string_view command) noexcept
+{
+  if (
+    m_deferred.empty() or m_deferred.back().write_behind or
+    *m_deferred.back().query != command)
+    return false;
+  m_deferred.pop_back();
+  return true;
+}
+
+
+bool pqxx::connection::discard_deferred(std::string_view command) noexcept
+{
+  auto const here{std::find_if(
+    m_deferred.rbegin(), m_deferred.rend(),
+    [command](internal::queued_statement const &s) {
+      return not s.write_behind and not s.release and *s.query == command;
+    })};
+  if (command.empty() or here == m_deferred.rend())
+  {
+    m_deferred.clear();
+    return false;
+  }
+  m_deferred.erase(std::prev(here.base()), std::end(m_deferred));
+  return true;
+}
+
+
+bool pqxx::connection::has_write_behind() const noexcept
+{
+  return std::any_of(
+    std::begin(m_deferred), std::end(m_deferred),
+    [](internal::queued_statement const &s) { return s.write_behind; });
+}
+
+
+void pqxx::connection::flush_deferred()
+{
+  if (m_deferred.empty())
+    return;
+  if (has_write_behind())
+  {
+    exec_with_deferred(nullptr, internal::params{}, false);
+    return;
+  }
+  std::string text;
+  for (auto const &command : m_deferred)
+  {
+    if (not text.empty())
+      text += "; ";
+    text += *command.query;
+  }
+  m_deferred.clear();
+  exec(text);
+}
+
+
+pqxx::result
+pqxx::connection::exec_single(std::shared_ptr<std::string> command)
+{
+  if (has_write_behind())
+    return exec_with_deferred(command, internal::params{}, false);
+  else
+    return exec(command);
+}
+
+
+bool pqxx::connection::in_failed_transaction() const noexcept
+{
+  return PQtransactionStatus(m_conn) == PQTRANS_INERROR;
+}
+
+
+void pqxx::connection::check_queued(
+  internal::queued_statement const &s, internal::pq::PGresult *pgr)
+{
+  auto const r{make_result(pgr, s.query)};
+  if (s.write_behind and not r.empty())
+    throw unexpected_rows{"Expected 0 row(s) of data from write-behind "
+                          "statement '" +
+                          *s.query + "', got " + to_string(r.size()) + "."};
+}
+
+
+namespace
+{
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+/// Send a statement in pipeline mode.  Returns whether that succeeded.
+bool send_statement(
+  pqxx::internal::pq::PGconn *conn, std::string const &query,
+  pqxx::internal::params const &args, bool prepared,
+  pqxx::format result_format = pqxx::format::text)
+{
+  auto const pointers{args.get_pointers()};
+  auto const nonnulls{
+    pqxx::check_cast<int>(args.nonnulls.size(), "pipelined statement")};
+  auto const fmt{static_cast<int>(result_format)};
+  if (prepared)
+    return PQsendQueryPrepared(
+             conn, query.c_str(), nonnulls, pointers.data(),
+             args.lengths.data(), args.binaries.data(), fmt) != 0;
+  else
+    return PQsendQueryParams(
+             conn, query.c_str(), nonnulls, nullptr, pointers.data(),
+             args.lengths.data(), args.binaries.data(), fmt) != 0;
+}
+#endif // PQXX_HAVE_PQ_PIPELINE
+} // namespace
+
+
+pqxx::result pqxx::connection::exec_with_deferred(
+  std::shared_ptr<std::string> const &query, internal::params const &args,
+  bool prepared, format result_format)
+{
+  auto const queue{std::move(m_deferred)};
+  m_deferred.clear();
+
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  if (PQenterPipelineMode(m_conn) == 0)
+    throw failure{err_msg()};
+  bool sent{true};
+  for (auto const &s : queue)
+    sent = sent and send_statement(m_conn, *s.query, s.args, s.prepared);
+  if (query)
+    sent =
+      sent and send_statement(m_conn, *query, args, prepared, result_format);
+  sent = sent and PQpipelineSync(m_conn) != 0;
+  if (not sent)
+  {
+    std::string const msg{err_msg()};
+    PQexitPipelineMode(m_conn);
+    throw failure{msg};
+  }
+
+  // Collect the first result for each statement, up to the sync.  Each
+  // statement's results end in a null.
+  auto const count{queue.size() + (query ? 1u : 0u)};
+  using result_ptr = std::unique_ptr<
+    internal::pq::PGresult, void (*)(internal::pq::PGresult *)>;
+  std::vector<result_ptr> results;
+  results.reserve(count);
+  for (std::size_t stmt{0}; stmt < count; ++stmt)
+    results.emplace_back(nullptr, PQclear);
+  for (std::size_t stmt{0}; stmt < count;)
+  {
+    result_ptr res{PQgetResult(m_conn), PQclear};
+    if (not res)
+      ++stmt;
+    else if (PQresultStatus(res.get()) == PGRES_PIPELINE_SYNC)
+      break;
+    else if (not results[stmt])
+      results[stmt] = std::move(res);
+  }
+  while (result_ptr const res{PQgetResult(m_conn), PQclear})
+    if (PQresultStatus(res.get()) == PGRES_PIPELINE_SYNC)
+      break;
+  PQexitPipelineMode(m_conn);
+
+  // Report the first failure, as that of the statement that caused it.  The
+  // statements after it won't have been executed.
+  for (std::size_t i{0}; i < queue.size(); ++i)
+    check_queued(queue[i], results[i].release());
+  if (not query)
+    return result{};
+  auto const r{make_result(results.back().release(), query)};
+  get_notifs();
+  return r;
+#else
+  // No pipeline mode.  Execute queued statements one by one.
+  for (auto const &s : queue)
+  {
+    if (s.prepared)
+      check_queued(s, PQexecPrepared(
+                        m_conn, s.query->c_str(),
+                        check_cast<int>(
+                          s.args.nonnulls.size(), "queued statement"),
+                        s.args.get_pointers().data(), s.args.lengths.data(),
+                        s.args.binaries.data(), 0));
+    else if (s.args.lengths.empty())
+      check_queued(s, PQexec(m_conn, s.query->c_str()));
+    else
+      check_queued(s, PQexecParams(
+                        m_conn, s.query->c_str(),
+                        check_cast<int>(
+                          s.args.nonnulls.size(), "queued statement"),
+                        nullptr, s.args.get_pointers().data(),
+                        s.args.lengths.data(), s.args.binaries.data(), 0));
+  }
+  if (not query)
+    return result{};
+  else if (prepared)
+    return exec_prepared(*query, args);
+  else
+    return exec_params(*query, args, result_format);
+#endif // PQXX_HAVE_PQ_PIPELINE
+}
+
+
 std::string pqxx::connection::encrypt_password(
   char const user[], char const password[], char const *algorithm)
 {
@@ -621,8 +874,10 @@ void pqxx::connection::unprepare(std::string_view name)
 pqxx::result pqxx::connection::exec_prepared(
   std::string_view statement, internal::params const &args)
 {
-  auto const pointers{args.get_pointers()};
   auto const q{std::make_shared<std::string>(statement)};
+  if (not m_deferred.empty())
+    return exec_with_deferred(q, args, true);
+  auto const pointers{args.get_pointers()};
   auto const pq_result{PQexecPrepared(
     m_conn, q->c_str(), check_cast<int>(args.nonnulls.size(), "exec_prepared"),
     pointers.data(), args.lengths.data(), args.binaries.data(), 0)};
@@ -678,6 +933,7 @@ void pqxx::connection::register_transaction(transaction_base *t)
 
 void pqxx::connection::unregister_transaction(transaction_base *t) noexcept
 {
+  m_deferred.clear();
   try
   {
     m_trans.unregister_guest(t);
@@ -755,11 +1011,75 @@ void pqxx::connection::end_copy_write()
 
 void pqxx::connection::start_exec(char const query[])
 {
+  flush_deferred();
   if (PQsendQuery(m_conn, query) == 0)
     throw failure{err_msg()};
 }
 
 
+void pqxx::connection::start_exec_params(
+  char const query[], internal::params const &args)
+{
+  flush_deferred();
+  auto const pointers{args.get_pointers()};
+  if (
+    PQsendQueryParams(
+      m_conn, query,
+      check_cast<int>(args.nonnulls.size(), "start_exec_params() parameters"),
+      nullptr, pointers.data(), args.lengths.data(), args.binaries.data(),
+      0) == 0)
+    throw failure{err_msg()};
+}
+
+
+void pqxx::connection::start_exec_prepared(
+  char const statement[], internal::params const &args)
+{
+  flush_deferred();
+  auto const pointers{args.get_pointers()};
+  if (
+    PQsendQueryPrepared(
+      m_conn, statement,
+      check_cast<int>(args.nonnulls.size(), "start_exec_prepared()"),
+      pointers.data(), args.lengths.data(), args.binaries.data(), 0) == 0)
+    throw failure{err_msg()};
+}
+
+
+bool pqxx::connection::enter_pipeline_mode()
+{
+  flush_deferred();
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  if (PQenterPipelineMode(m_conn) == 0)
+    throw failure{err_msg()};
+  return true;
+#else
+  return false;
+#endif // PQXX_HAVE_PQ_PIPELINE
+}
+
+
+void pqxx::connection::pipeline_sync()
+{
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  if (PQpipelineSync(m_conn) == 0)
+    throw failure{err_msg()};
+#else
+  throw feature_not_supported{"This libpq does not support pipeline mode."};
+#endif // PQXX_HAVE_PQ_PIPELINE
+}
+
+
+bool pqxx::connection::exit_pipeline_mode() noexcept
+{
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  return PQexitPipelineMode(m_conn) != 0;
+#else
+  return true;
+#endif // PQXX_HAVE_PQ_PIPELINE
+}
+
+
 pqxx::internal::pq::PGresult *pqxx::connection::get_result()
 {
   return PQgetResult(m_conn);
@@ -1032,15 +1352,18 @@ int pqxx::connection::encoding_id() const
 
 
 pqxx::result pqxx::connection::exec_params(
-  std::string_view query, internal::params const &args)
+  std::string_view query, internal::params const &args, format result_format)
 {
-  auto const pointers{args.get_pointers()};
   auto const q{std::make_shared<std::string>(query)};
+  if (not m_deferred.empty())
+    return exec_with_deferred(q, args, false, result_format);
+  auto const pointers{args.get_pointers()};
   auto const nonnulls{
     check_cast<int>(args.nonnulls.size(), "exec_params() parameters")};
   auto const pq_result{PQexecParams(
     m_conn, q->c_str(), nonnulls, nullptr, pointers.data(),
-    args.lengths.data(), args.binaries.data(), 0)};
+    args.lengths.data(), args.binaries.data(),
+    static_cast<int>(result_format))};
   auto const r{make_result(pq_result, q)};
   get_notifs();
   return r;
@@ -0,0 +1,189 @@
+/** Implementation of the pqxx::connection_multiplexer class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "pqxx/connection_multiplexer"
+#include "pqxx/nontransaction"
+#include "pqxx/pipeline"
+
+#include "pqxx/internal/gates/pipeline-connection_multiplexer.hxx"
+
+
+pqxx::connection_multiplexer::connection_multiplexer(connection &&c) :
+        m_conn{std::move(c)},
+        m_options{m_conn.connection_string()},
+        m_worker{&connection_multiplexer::loop, this}
+{}
+
+
+pqxx::connection_multiplexer::~connection_multiplexer() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  m_worker.join();
+
+  // Anything that slipped in during shutdown gets a broken promise.
+  for (auto j{m_head.exchange(nullptr)}; j != nullptr;)
+    delete std::exchange(j, j->next);
+}
+
+
+std::future<pqxx::result> pqxx::connection_multiplexer::submit(
+  query_kind kind, std::string &&query, std::unique_ptr<internal::params> args)
+{
+  if (m_stopping)
+    throw usage_error{"Submitting query to a multiplexer that's closing."};
+
+  auto j{std::make_unique<job>()};
+  j->kind = kind;
+  j->query = std::move(query);
+  j->args = std::move(args);
+  auto f{j->done.get_future()};
+
+  auto const node{j.release()};
+  node->next = m_head.load(std::memory_order_relaxed);
+  while (not m_head.compare_exchange_weak(
+    node->next, node, std::memory_order_release, std::memory_order_relaxed))
+    ;
+
+  // If the stack was empty, the background thread may be asleep.  Taking the
+  // lock makes sure it's either waiting or yet to check for work.
+  if (node->next == nullptr)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+  }
+  m_wake.notify_one();
+  return f;
+}
+
+
+void pqxx::connection_multiplexer::loop() noexcept
+{
+  for (;;)
+  {
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_wake.wait(lock, [this] {
+        return m_stopping or m_head.load(std::memory_order_relaxed);
+      });
+    }
+
+    auto list{m_head.exchange(nullptr, std::memory_order_acquire)};
+    if (list == nullptr)
+    {
+      if (m_stopping)
+        return;
+      continue;
+    }
+
+    // The stack is newest-first.  Run them in the order they came in.
+    std::vector<std::unique_ptr<job>> batch;
+    for (; list != nullptr; list = list->next) batch.emplace_back(list);
+    std::reverse(std::begin(batch), std::end(batch));
+    for (auto &j : batch) j->next = nullptr;
+
+    run_batch(batch);
+  }
+}
+
+
+void pqxx::connection_multiplexer::prepare(
+  std::string name, std::string definition)
+{
+  std::lock_guard<std::mutex> lock{m_statements_mutex};
+  m_statements.emplace_back(std::move(name), std::move(definition));
+}
+
+
+void pqxx::connection_multiplexer::reconnect()
+{
+  m_conn = connection{m_options};
+  m_prepared = 0;
+}
+
+
+void pqxx::connection_multiplexer::prepare_statements()
+{
+  decltype(m_statements) todo;
+  {
+    std::lock_guard<std::mutex> lock{m_statements_mutex};
+    todo.assign(
+      std::next(std::begin(m_statements), std::ptrdiff_t(m_prepared)),
+      std::end(m_statements));
+  }
+  for (auto const &[name, definition] : todo)
+  {
+    m_conn.prepare(name, definition);
+    ++m_prepared;
+  }
+}
+
+
+void pqxx::connection_multiplexer::run_batch(
+  std::vector<std::unique_ptr<job>> &batch)
+{
+  // Jobs that got their result (or error) so far.
+  std::size_t done{0};
+  try
+  {
+    if (not m_conn.is_open())
+      reconnect();
+    prepare_statements();
+
+    nontransaction tx{m_conn};
+    pipeline pipe{tx};
+    internal::gate::pipeline_connection_multiplexer gate{pipe};
+    gate.isolate();
+    pipe.retain(static_cast<int>(std::min(batch.size(), std::size_t{1000})));
+    std::vector<pipeline::query_id> ids;
+    ids.reserve(batch.size());
+    for (auto const &j : batch)
+    {
+      switch (j->kind)
+      {
+      case query_kind::text: ids.push_back(gate.insert(j->query)); break;
+      case query_kind::params:
+        ids.push_back(gate.insert_params(j->query, std::move(j->args)));
+        break;
+      case query_kind::prepared:
+        ids.push_back(gate.insert_prepared(j->query, std::move(j->args)));
+        break;
+      }
+    }
+    pipe.complete();
+    ++m_batches;
+
+    // Each query ran in its own implicit transaction, so each outcome stands
+    // on its own.
+    for (; done < batch.size(); ++done)
+    {
+      auto &j{batch[done]};
+      try
+      {
+        j->done.set_value(pipe.retrieve(ids[done]));
+      }
+      catch (std::exception const &)
+      {
+        j->done.set_exception(std::current_exception());
+      }
+    }
+  }
+  catch (std::exception const &)
+  {
+    for (; done < batch.size(); ++done)
+      batch[done]->done.set_exception(std::current_exception());
+  }
+}
@@ -0,0 +1,302 @@
+/** Implementation of the pqxx::connection_pool class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <algorithm>
+#include <limits>
+
+#include "pqxx/connection_pool"
+#include "pqxx/except"
+
+
+namespace
+{
+char const *name_of(pqxx::connection_pool::priority p) noexcept
+{
+  switch (p)
+  {
+  case pqxx::connection_pool::priority::interactive: return "interactive";
+  case pqxx::connection_pool::priority::normal: return "normal";
+  case pqxx::connection_pool::priority::batch: return "batch";
+  }
+  return "unknown";
+}
+} // namespace
+
+
+pqxx::connection_pool::connection_pool(
+  std::string options, std::size_t max_size) :
+        m_options{std::move(options)}, m_max_size{max_size}
+{
+  if (max_size == 0)
+    throw range_error{"Connection pool must allow at least 1 connection."};
+  for (auto &c : m_classes)
+  {
+    c.limit = max_size;
+    c.max_queued = std::numeric_limits<std::size_t>::max();
+  }
+}
+
+
+pqxx::connection_pool::~connection_pool() noexcept = default;
+
+
+pqxx::connection_pool::lease pqxx::connection_pool::acquire(priority p)
+{
+  std::chrono::milliseconds timeout;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    timeout = get_class(p).timeout;
+  }
+  if (timeout.count() == 0)
+    return wait_for_connection(p, nullptr);
+  else
+    return acquire(p, timeout);
+}
+
+
+pqxx::connection_pool::lease
+pqxx::connection_pool::acquire(priority p, std::chrono::milliseconds timeout)
+{
+  auto const deadline{std::chrono::steady_clock::now() + timeout};
+  return wait_for_connection(p, &deadline);
+}
+
+
+bool pqxx::connection_pool::may_admit(priority p) const noexcept
+{
+  if (m_idle.empty() and m_open >= m_max_size)
+    return false;
+  auto const &cls{get_class(p)};
+  if (cls.stats.in_use >= cls.limit)
+    return false;
+  // Higher classes go first, unless they're at their limits.
+  for (std::size_t h{0}; h < static_cast<std::size_t>(p); ++h)
+  {
+    auto const &higher{m_classes[h]};
+    if (not higher.queue.empty() and higher.stats.in_use < higher.limit)
+      return false;
+  }
+  return true;
+}
+
+
+pqxx::connection_pool::lease pqxx::connection_pool::wait_for_connection(
+  priority p, std::chrono::steady_clock::time_point const *deadline)
+{
+  auto const start{std::chrono::steady_clock::now()};
+  std::unique_lock<std::mutex> lock{m_mutex};
+  auto &cls{get_class(p)};
+  // Only a request that would actually have to wait counts against the limit.
+  bool const must_wait{not cls.queue.empty() or not may_admit(p)};
+  if (must_wait and cls.queue.size() >= cls.max_queued)
+  {
+    ++cls.stats.rejected;
+    throw pool_exhausted{
+      std::string{"Too many requests waiting for a connection in class '"} +
+      name_of(p) + "'."};
+  }
+
+  auto const ticket{m_next_ticket++};
+  cls.queue.push_back(ticket);
+  auto const ready{
+    [this, p, &cls, ticket] {
+      return cls.queue.front() == ticket and may_admit(p);
+    }};
+  if (deadline == nullptr)
+  {
+    m_available.wait(lock, ready);
+  }
+  else if (not m_available.wait_until(lock, *deadline, ready))
+  {
+    cls.queue.erase(
+      std::find(std::begin(cls.queue), std::end(cls.queue), ticket));
+    ++cls.stats.timeouts;
+    lock.unlock();
+    // The next in line may be able to go now.
+    m_available.notify_all();
+    throw pool_exhausted{
+      std::string{"Timed out waiting for a connection in class '"} +
+      name_of(p) + "'."};
+  }
+
+  cls.queue.pop_front();
+  ++cls.stats.in_use;
+  ++cls.stats.acquired;
+  auto const waited{std::chrono::steady_clock::now() - start};
+  cls.stats.total_wait += waited;
+  cls.stats.max_wait = std::max(cls.stats.max_wait, waited);
+
+  if (not m_idle.empty())
+  {
+    auto idle{std::move(m_idle.back())};
+    m_idle.pop_back();
+    bool const behind{idle.prepared < m_statements.size()};
+    lock.unlock();
+    m_available.notify_all();
+    lease l{*this, std::move(idle.conn), p, idle.prepared};
+    if (behind)
+      prepare_statements(l);
+    return l;
+  }
+  ++m_open;
+  lock.unlock();
+  m_available.notify_all();
+
+  // Open a new connection, outside the lock: this can take a while.
+  std::unique_ptr<connection> conn;
+  try
+  {
+    conn = std::make_unique<connection>(m_options);
+  }
+  catch (std::exception const &)
+  {
+    {
+      std::lock_guard<std::mutex> relock{m_mutex};
+      --m_open;
+      --cls.stats.in_use;
+    }
+    m_available.notify_all();
+    throw;
+  }
+  lease l{*this, std::move(conn), p, 0};
+  prepare_statements(l);
+  return l;
+}
+
+
+void pqxx::connection_pool::prepare_statements(lease &l)
+{
+  decltype(m_statements) todo;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    todo.assign(
+      std::next(std::begin(m_statements), std::ptrdiff_t(l.m_prepared)),
+      std::end(m_statements));
+  }
+  // If this fails, the lease's destructor gives the connection back.
+  for (auto const &[name, definition] : todo)
+  {
+    l.m_conn->prepare(name, definition);
+    ++l.m_prepared;
+  }
+}
+
+
+void pqxx::connection_pool::prepare(std::string name, std::string definition)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_statements.emplace_back(std::move(name), std::move(definition));
+}
+
+
+void pqxx::connection_pool::set_class_limit(priority p, std::size_t limit)
+{
+  if (limit == 0)
+    throw range_error{"Priority class must allow at least 1 connection."};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    get_class(p).limit = limit;
+  }
+  m_available.notify_all();
+}
+
+
+void pqxx::connection_pool::set_max_queued(priority p, std::size_t max_queued)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  get_class(p).max_queued = max_queued;
+}
+
+
+void pqxx::connection_pool::set_queue_timeout(
+  priority p, std::chrono::milliseconds timeout)
+{
+  if (timeout.count() < 0)
+    throw range_error{"Negative queue timeout."};
+  std::lock_guard<std::mutex> lock{m_mutex};
+  get_class(p).timeout = timeout;
+}
+
+
+pqxx::connection_pool::class_stats
+pqxx::connection_pool::stats(priority p) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  auto const &cls{get_class(p)};
+  auto out{cls.stats};
+  out.queued = cls.queue.size();
+  return out;
+}
+
+
+std::size_t pqxx::connection_pool::in_use() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_open - m_idle.size();
+}
+
+
+std::size_t pqxx::connection_pool::idle() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_idle.size();
+}
+
+
+void pqxx::connection_pool::give_back(
+  std::unique_ptr<connection> &&conn, std::size_t prepared,
+  priority p) noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    --get_class(p).stats.in_use;
+    if (conn->is_open())
+    {
+      try
+      {
+        m_idle.push_back(idle_connection{std::move(conn), prepared});
+      }
+      catch (std::exception const &)
+      {
+        --m_open;
+      }
+    }
+    else
+    {
+      --m_open;
+    }
+  }
+  // Close a connection we're dropping, if any, outside the lock.
+  conn.reset();
+  // Wake everyone: the request that's next in line may be in any class.
+  m_available.notify_all();
+}
+
+
+pqxx::connection_pool::lease &
+pqxx::connection_pool::lease::operator=(lease &&rhs) noexcept
+{
+  if (&rhs != this)
+  {
+    release();
+    m_pool = rhs.m_pool;
+    m_conn = std::move(rhs.m_conn);
+    m_priority = rhs.m_priority;
+    m_prepared = rhs.m_prepared;
+  }
+  return *this;
+}
+
+
+void pqxx::connection_pool::lease::release() noexcept
+{
+  if (m_conn)
+    m_pool->give_back(std::move(m_conn), m_prepared, m_priority);
+}
@@ -10,6 +10,7 @@
  */
 #include "pqxx-source.hxx"
 
+#include <algorithm>
 #include <iterator>
 
 #include "pqxx/cursor"
@@ -52,18 +53,32 @@ pqxx::internal::obtain_stateless_cursor_size(sql_cursor &cur)
 }
 
 
-pqxx::result pqxx::internal::stateless_cursor_retrieve(
-  sql_cursor &cur, result::difference_type size,
-  result::difference_type begin_pos, result::difference_type end_pos)
+namespace
+{
+/// Check and normalise a stateless_cursor retrieval range.
+/** Returns the end position, clipped to the result set.
+ */
+pqxx::result::difference_type check_range(
+  pqxx::result::difference_type size, pqxx::result::difference_type begin_pos,
+  pqxx::result::difference_type end_pos)
 {
   if (begin_pos < 0 or begin_pos > size)
-    throw range_error{"Starting position out of range"};
+    throw pqxx::range_error{"Starting position out of range"};
 
   if (end_pos < -1)
-    end_pos = -1;
+    return -1;
   else if (end_pos > size)
-    end_pos = size;
+    return size;
+  return end_pos;
+}
+} // namespace
+
 
+pqxx::result pqxx::internal::stateless_cursor_retrieve(
+  sql_cursor &cur, result::difference_type size,
+  result::difference_type begin_pos, result::difference_type end_pos)
+{
+  end_pos = check_range(size, begin_pos, end_pos);
   if (begin_pos == end_pos)
     return cur.empty_result();
 
@@ -73,6 +88,175 @@ pqxx::result pqxx::internal::stateless_cursor_retrieve(
 }
 
 
+pqxx::internal::cursor_block_cache::cursor_block_cache(
+  difference_type block_rows, std::size_t max_blocks) :
+        m_block_rows{block_rows},
+        m_max_blocks{max_blocks}
+{
+  if (block_rows <= 0)
+    throw range_error{"Cursor cache block size must be positive."};
+  if (max_blocks == 0)
+    throw range_error{"Cursor cache must hold at least one block."};
+}
+
+
+pqxx::result pqxx::internal::cursor_block_cache::retrieve(
+  sql_cursor &cur, difference_type size, difference_type begin_pos,
+  difference_type end_pos)
+{
+  end_pos = check_range(size, begin_pos, end_pos);
+  if (begin_pos == end_pos)
+    return cur.empty_result();
+
+  auto const index{begin_pos / m_block_rows};
+  if (begin_pos > end_pos or index != (end_pos - 1) / m_block_rows)
+  {
+    // Not within a single block.  Fetch directly.
+    ++m_misses;
+    m_last_block = -1;
+    return stateless_cursor_retrieve(cur, size, begin_pos, end_pos);
+  }
+
+  auto const &block{get_block(cur, size, index)};
+  auto const offset{index * m_block_rows};
+  if (begin_pos == offset and end_pos - begin_pos == block.size())
+    return block;
+  return sql_cursor::copy_rows(
+    block, result::size_type(begin_pos - offset),
+    result::size_type(end_pos - offset));
+}
+
+
+pqxx::result const &pqxx::internal::cursor_block_cache::get_block(
+  sql_cursor &cur, difference_type size, difference_type index)
+{
+  bool const sequential{index == m_last_block + 1 and index > 0};
+  m_last_block = index;
+
+  auto const found{m_index.find(index)};
+  if (found != std::end(m_index))
+  {
+    ++m_hits;
+    m_blocks.splice(std::begin(m_blocks), m_blocks, found->second);
+    return m_blocks.front().second;
+  }
+
+  ++m_misses;
+  auto const begin_pos{index * m_block_rows};
+  // On sequential access, fetch the next block in the same round trip.
+  auto const want{(sequential and m_max_blocks > 1) ? 2 * m_block_rows :
+                                                      m_block_rows};
+  auto const end_pos{std::min(begin_pos + want, size)};
+  auto const r{stateless_cursor_retrieve(cur, size, begin_pos, end_pos)};
+  if (r.size() > m_block_rows)
+  {
+    auto const split{result::size_type(m_block_rows)};
+    add_block(index + 1, sql_cursor::copy_rows(r, split, r.size()));
+    add_block(index, sql_cursor::copy_rows(r, 0, split));
+  }
+  else
+  {
+    add_block(index, r);
+  }
+  return m_blocks.front().second;
+}
+
+
+void pqxx::internal::cursor_block_cache::add_block(
+  difference_type index, result const &r)
+{
+  auto const old{m_index.find(index)};
+  if (old != std::end(m_index))
+  {
+    m_blocks.erase(old->second);
+    m_index.erase(old);
+  }
+  m_blocks.emplace_front(index, r);
+  m_index.emplace(index, std::begin(m_blocks));
+  while (m_blocks.size() > m_max_blocks)
+  {
+    m_index.erase(m_blocks.back().first);
+    m_blocks.pop_back();
+  }
+}
+
+
+pqxx::adaptive_stride::adaptive_stride(
+  std::size_t target_bytes, duration target_latency,
+  difference_type min_stride, difference_type max_stride,
+  std::size_t max_bytes) :
+        m_target_bytes{target_bytes},
+        m_target_latency{target_latency},
+        m_min_stride{min_stride},
+        m_max_stride{max_stride},
+        m_max_bytes{max_bytes},
+        m_stride{min_stride}
+{
+  if (min_stride < 1)
+    throw argument_error{"Minimum cursor stride must be positive; got " +
+                         to_string(min_stride) + "."};
+  if (max_stride < min_stride)
+    throw argument_error{"Maximum cursor stride " + to_string(max_stride) +
+                         " is less than minimum " + to_string(min_stride) +
+                         "."};
+  if (target_bytes == 0 or target_latency <= duration::zero())
+    throw argument_error{"Adaptive cursor stride needs positive targets."};
+}
+
+
+void pqxx::adaptive_stride::observe(
+  difference_type rows, std::size_t bytes, std::size_t widest_row,
+  duration elapsed)
+{
+  if (rows <= 0)
+    return;
+
+  // Smooth out the row width a bit, but let it follow changes in the data.
+  auto const width{std::max(double(bytes) / double(rows), 1.0)};
+  m_row_width = (m_row_width == 0) ? width : (m_row_width + width) / 2;
+  m_widest_row = std::max(m_widest_row, widest_row);
+
+  // Rows that fit in the byte budget.
+  auto next{double(m_target_bytes) / m_row_width};
+
+  // Rows that we expect to fetch within the latency target.  This assumes
+  // that fetch time is proportional to the number of rows, which is a bit
+  // pessimistic since part of it is a fixed round-trip cost.  But it means
+  // that a slow link or a slow query shrinks the stride.
+  if (elapsed > duration::zero())
+    next = std::min(
+      next, double(rows) * double(m_target_latency.count()) /
+              double(elapsed.count()));
+
+  // Grow gradually.
+  next = std::min(next, 2.0 * double(m_stride));
+
+  next = std::clamp(next, double(m_min_stride), double(m_max_stride));
+  if (m_max_bytes > 0 and m_widest_row > 0)
+    next = std::min(next, double(m_max_bytes / m_widest_row));
+
+  m_stride = std::max(difference_type(next), difference_type(1));
+}
+
+
+namespace pqxx::internal
+{
+/// Keeps an icursorstream's transaction busy while a FETCH is in flight.
+class cursor_prefetch : public transactionfocus
+{
+public:
+  cursor_prefetch(transaction_base &t, std::string const &cursor) :
+          namedclass{"icursorstream", cursor},
+          transactionfocus{t}
+  {
+    register_me();
+  }
+
+  ~cursor_prefetch() noexcept { unregister_me(); }
+};
+} // namespace pqxx::internal
+
+
 pqxx::icursorstream::icursorstream(
   transaction_base &context, std::string_view query, std::string_view basename,
   difference_type sstride) :
@@ -86,6 +270,7 @@ pqxx::icursorstream::icursorstream(
         m_stride{sstride},
         m_realpos{0},
         m_reqpos{0},
+        m_context{context},
         m_iterators{nullptr},
         m_done{false}
 {
@@ -100,6 +285,7 @@ pqxx::icursorstream::icursorstream(
         m_stride{sstride},
         m_realpos{0},
         m_reqpos{0},
+        m_context{context},
         m_iterators{nullptr},
         m_done{false}
 {
@@ -107,27 +293,140 @@ pqxx::icursorstream::icursorstream(
 }
 
 
+pqxx::icursorstream::~icursorstream() noexcept
+{
+  if (m_prefetching)
+  {
+    try
+    {
+      finish_prefetch();
+    }
+    catch (std::exception const &)
+    {}
+  }
+}
+
+
 void pqxx::icursorstream::set_stride(difference_type stride)
 {
   if (stride < 1)
     throw argument_error{"Attempt to set cursor stride to " +
                          to_string(stride)};
   m_stride = stride;
+  m_adaptive.reset();
+}
+
+
+void pqxx::icursorstream::set_stride(adaptive_stride const &policy)
+{
+  m_adaptive = policy;
+  m_stride = policy.stride();
+}
+
+
+void pqxx::icursorstream::start_prefetch()
+{
+  m_prefetching = std::make_unique<internal::cursor_prefetch>(
+    m_context, m_cur.name());
+  try
+  {
+    m_cur.start_fetch(m_stride);
+  }
+  catch (std::exception const &)
+  {
+    m_prefetching.reset();
+    throw;
+  }
+}
+
+
+pqxx::result pqxx::icursorstream::finish_prefetch()
+{
+  // Release the transaction first, even if the FETCH failed.
+  m_prefetching.reset();
+  difference_type displacement{0};
+  return m_cur.finish_fetch(displacement);
 }
 
 
 pqxx::result pqxx::icursorstream::fetchblock()
 {
-  result const r{m_cur.fetch(m_stride)};
+  auto const start{std::chrono::steady_clock::now()};
+  result r;
+  difference_type requested{m_stride};
+  bool fetched_ahead{true};
+  if (not m_leftover.empty())
+  {
+    r = m_leftover;
+    m_leftover.clear();
+    requested = difference_type(r.size());
+  }
+  else if (m_prefetching)
+  {
+    requested = m_cur.pending_fetch();
+    r = finish_prefetch();
+  }
+  else
+  {
+    r = m_cur.fetch(m_stride);
+    fetched_ahead = false;
+  }
   m_realpos += r.size();
   if (r.empty())
     m_done = true;
+
+  if (m_adaptive and m_iterators == nullptr and not r.empty())
+  {
+    // The time it took us to obtain a prefetched block says nothing about
+    // the time the FETCH took.
+    auto const elapsed{
+      fetched_ahead ? std::chrono::steady_clock::duration::zero() :
+                      std::chrono::steady_clock::now() - start};
+    std::size_t bytes{0}, widest{0};
+    for (auto const &row : r)
+    {
+      std::size_t width{0};
+      for (auto const &f : row) width += f.size();
+      bytes += width;
+      widest = std::max(widest, width);
+    }
+    m_adaptive->observe(difference_type(r.size()), bytes, widest, elapsed);
+    m_stride = m_adaptive->stride();
+  }
+
+  // If we got fewer rows than we asked for, we're at the end.  No sense in
+  // fetching ahead then.
+  if (
+    m_prefetch and not m_prefetching and
+    difference_type(r.size()) == requested and not r.empty())
+    start_prefetch();
+
   return r;
 }
 
 
 pqxx::icursorstream &pqxx::icursorstream::ignore(std::streamsize n)
 {
+  // Rows we already fetched ahead come first.
+  if (m_leftover.empty() and m_prefetching)
+    m_leftover = finish_prefetch();
+  if (not m_leftover.empty())
+  {
+    auto const have{std::streamsize(m_leftover.size())};
+    if (n < have)
+    {
+      m_leftover = internal::sql_cursor::copy_rows(
+        m_leftover, result::size_type(n), result::size_type(have));
+      m_realpos += n;
+      return *this;
+    }
+    m_leftover.clear();
+    m_realpos += have;
+    n -= have;
+    if (n == 0)
+      return *this;
+  }
+
   auto offset{m_cur.move(difference_type(n))};
   m_realpos += offset;
   if (offset < n)
@@ -54,6 +54,11 @@ pqxx::in_doubt_error::in_doubt_error(std::string const &whatarg) :
 {}
 
 
+pqxx::pool_exhausted::pool_exhausted(std::string const &whatarg) :
+        failure{whatarg}
+{}
+
+
 pqxx::transaction_rollback::transaction_rollback(
   std::string const &whatarg, std::string const &q, char const sqlstate[]) :
         sql_error{whatarg, q, sqlstate}
@@ -10,6 +10,7 @@
  */
 #include "pqxx-source.hxx"
 
+#include <cstdint>
 #include <cstring>
 
 #include "pqxx/internal/libpq-forward.hxx"
@@ -75,3 +76,87 @@ pqxx::field::size_type pqxx::field::size() const noexcept
 {
   return home().get_length(idx(), col());
 }
+
+
+bool pqxx::field::is_binary() const noexcept
+{
+  return home().column_format(col()) == format::binary;
+}
+
+
+void pqxx::field::throw_binary_mismatch(std::string const &target) const
+{
+  throw conversion_error{
+    "Can't convert binary field of type " + to_string(type()) + " to " +
+    target + "."};
+}
+
+
+pqxx::internal::binary_kind pqxx::internal::binary_kind_of(oid type)
+{
+  // These are the built-in types' oids, as in the pg_type catalog.
+  switch (type)
+  {
+  case 16: return binary_kind::boolean;
+  case 17: return binary_kind::bytes;
+  case 19:   // name
+  case 25:   // text
+  case 1042: // bpchar
+  case 1043: // varchar
+    return binary_kind::text;
+  case 20: // int8
+  case 21: // int2
+  case 23: // int4
+    return binary_kind::integer;
+  case 700: // float4
+  case 701: // float8
+    return binary_kind::floating;
+  default:
+    throw conversion_error{
+      "Can't decode binary data of type " + to_string(type) + "."};
+  }
+}
+
+
+long long pqxx::internal::decode_binary_int(char const data[], std::size_t len)
+{
+  if (len != 2 and len != 4 and len != 8)
+    throw conversion_error{
+      "Binary integer field has unexpected size: " + to_string(len) + "."};
+
+  // Network byte order.  Sign-extend from the most significant byte.
+  auto const bytes{reinterpret_cast<unsigned char const *>(data)};
+  unsigned long long value{(bytes[0] & 0x80u) ? ~0ull : 0ull};
+  for (std::size_t i{0}; i < len; ++i) value = (value << 8) | bytes[i];
+  return static_cast<long long>(value);
+}
+
+
+double pqxx::internal::decode_binary_float(char const data[], std::size_t len)
+{
+  auto const bytes{reinterpret_cast<unsigned char const *>(data)};
+  std::uint64_t bits{0};
+  for (std::size_t i{0}; i < len; ++i) bits = (bits << 8) | bytes[i];
+
+  switch (len)
+  {
+  case sizeof(float):
+  {
+    static_assert(sizeof(float) == sizeof(std::uint32_t));
+    auto const narrow{static_cast<std::uint32_t>(bits)};
+    float value;
+    std::memcpy(&value, &narrow, sizeof(value));
+    return value;
+  }
+  case sizeof(double):
+  {
+    static_assert(sizeof(double) == sizeof(std::uint64_t));
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  default:
+    throw conversion_error{
+      "Binary float field has unexpected size: " + to_string(len) + "."};
+  }
+}
@@ -0,0 +1,166 @@
+/** Implementation of the pqxx::group_committer class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <vector>
+
+#include "pqxx/group_committer"
+#include "pqxx/subtransaction"
+#include "pqxx/transaction"
+
+#include "pqxx/internal/gates/connection-group_committer.hxx"
+
+
+namespace
+{
+std::size_t check_batch_size(std::size_t max_batch)
+{
+  if (max_batch == 0)
+    throw pqxx::range_error{"Group commit batch size must be at least 1."};
+  return max_batch;
+}
+} // namespace
+
+pqxx::group_committer::group_committer(
+  connection &c, std::chrono::microseconds window, std::size_t max_batch) :
+        m_conn{c},
+        m_window{window},
+        m_max_batch{check_batch_size(max_batch)},
+        m_worker{&group_committer::loop, this}
+{}
+
+
+pqxx::group_committer::~group_committer() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stopping = true;
+  }
+  m_wake.notify_all();
+  m_worker.join();
+}
+
+
+std::future<void> pqxx::group_committer::submit(task t)
+{
+  job j{std::move(t), {}};
+  auto f{j.done.get_future()};
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_stopping)
+      throw usage_error{"Submitting work to a group committer that's closing."};
+    m_queue.push_back(std::move(j));
+  }
+  m_wake.notify_all();
+  return f;
+}
+
+
+std::size_t pqxx::group_committer::batches() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_batches;
+}
+
+
+std::size_t pqxx::group_committer::committed() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_committed;
+}
+
+
+void pqxx::group_committer::loop() noexcept
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  for (;;)
+  {
+    m_wake.wait(lock, [this] { return m_stopping or not m_queue.empty(); });
+    if (m_queue.empty())
+      return;
+
+    // Give other threads a short while to add to the batch.  Once we're
+    // shutting down, there's no point in waiting.
+    auto const deadline{std::chrono::steady_clock::now() + m_window};
+    m_wake.wait_until(lock, deadline, [this] {
+      return m_stopping or m_queue.size() >= m_max_batch;
+    });
+
+    auto const size{std::min(m_queue.size(), m_max_batch)};
+    std::deque<job> batch;
+    for (std::size_t i{0}; i < size; ++i)
+    {
+      batch.push_back(std::move(m_queue.front()));
+      m_queue.pop_front();
+    }
+
+    lock.unlock();
+    run_batch(batch);
+    lock.lock();
+  }
+}
+
+
+void pqxx::group_committer::run_batch(std::deque<job> &batch)
+{
+  // Jobs that succeeded, and now depend on the commit.
+  std::vector<job *> good;
+  good.reserve(batch.size());
+  // Jobs that haven't run yet.
+  auto next{batch.begin()};
+  try
+  {
+    // Lazy: the BEGIN and each SAVEPOINT go out along with the first
+    // statement that needs them.
+    pqxx::work tx{m_conn, begin_policy::lazy};
+    pqxx::internal::gate::connection_group_committer const gate{m_conn};
+    for (; next != batch.end(); ++next)
+    {
+      try
+      {
+        // The connection adorns the name, so each task gets a savepoint of
+        // its own.
+        subtransaction sub{tx, "group_commit", begin_policy::lazy};
+        next->func(sub);
+        // If the task caught an SQL error and carried on, the transaction
+        // is still failed.  Fail the task, and roll back to its savepoint
+        // before the next task starts.  Once the subtransaction commits,
+        // its deferred RELEASE would leave the failure to the next task.
+        if (gate.in_failed_transaction())
+          throw sql_error{
+            "Group commit task caught an SQL error but returned normally.  "
+            "Its work has been rolled back.",
+            "", "25P02"};
+        sub.commit();
+        good.push_back(&*next);
+      }
+      catch (...)
+      {
+        next->done.set_exception(std::current_exception());
+      }
+    }
+    tx.commit();
+  }
+  catch (...)
+  {
+    // Nothing got committed, so none of the jobs succeeded.
+    auto const err{std::current_exception()};
+    for (auto j : good) j->done.set_exception(err);
+    for (; next != batch.end(); ++next) next->done.set_exception(err);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    ++m_batches;
+    m_committed += good.size();
+  }
+  // Only now, with the COMMIT confirmed, is the work done.
+  for (auto j : good) j->done.set_value();
+}
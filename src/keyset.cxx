@@ -0,0 +1,156 @@
+/** Implementation of keyset pagination.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <cctype>
+
+#include "pqxx/keyset"
+#include "pqxx/prepared_statement"
+#include "pqxx/transaction"
+
+
+namespace
+{
+/// Strip trailing whitespace and semicolons off a query.
+std::string_view trim_query(std::string_view query)
+{
+  auto end{query.size()};
+  while (end > 0)
+  {
+    auto const c{static_cast<unsigned char>(query[end - 1])};
+    if (c != ';' and not std::isspace(c))
+      break;
+    --end;
+  }
+  return query.substr(0, end);
+}
+} // namespace
+
+
+pqxx::keyset_iterator::keyset_iterator(
+  connection &conn, std::string_view query, std::vector<std::string> keys,
+  difference_type sstride) :
+        m_conn{conn},
+        m_keys{std::move(keys)},
+        m_first{conn.adorn_name("keyset")},
+        m_next{conn.adorn_name("keyset")},
+        m_stride{sstride}
+{
+  set_stride(sstride);
+  if (m_keys.empty())
+    throw argument_error{"Keyset pagination needs at least one key column."};
+  query = trim_query(query);
+  if (query.empty())
+    throw usage_error{"Keyset pagination has empty query."};
+
+  std::string columns, params;
+  for (std::size_t i{0}; i < m_keys.size(); ++i)
+  {
+    if (i > 0)
+    {
+      columns += ", ";
+      params += ", ";
+    }
+    columns += conn.quote_name(m_keys[i]);
+    // Parameter $1 is the limit; the keys come after it.
+    params += "$" + to_string(i + 2);
+  }
+
+  std::string const base{
+    "SELECT * FROM (" + std::string{query} + ") AS pqxx_keyset "};
+  std::string const tail{"ORDER BY " + columns + " LIMIT $1"};
+  conn.prepare(m_first, base + tail);
+  try
+  {
+    conn.prepare(
+      m_next, base + "WHERE (" + columns + ") > (" + params + ") " + tail);
+  }
+  catch (std::exception const &)
+  {
+    conn.unprepare(m_first);
+    throw;
+  }
+}
+
+
+pqxx::keyset_iterator::~keyset_iterator() noexcept
+{
+  try
+  {
+    m_conn.unprepare(m_first);
+    m_conn.unprepare(m_next);
+  }
+  catch (std::exception const &e)
+  {
+    m_conn.process_notice(
+      "Could not unprepare keyset statements: " + std::string{e.what()} +
+      "\n");
+  }
+}
+
+
+void pqxx::keyset_iterator::set_stride(difference_type stride)
+{
+  if (stride < 1)
+    throw argument_error{"Attempt to set keyset stride to " +
+                         to_string(stride)};
+  m_stride = stride;
+}
+
+
+void pqxx::keyset_iterator::resume_after(std::vector<std::string> key)
+{
+  if (key.size() != m_keys.size())
+    throw argument_error{
+      "Keyset has " + to_string(m_keys.size()) + " column(s), but got " +
+      to_string(key.size()) + " value(s) to resume after."};
+  m_last_key = std::move(key);
+  m_done = false;
+}
+
+
+pqxx::result pqxx::keyset_iterator::fetchblock()
+{
+  if (m_done)
+    return result{};
+
+  result r;
+  {
+    read_transaction tx{m_conn, "keyset"};
+    if (m_last_key.empty())
+      r = tx.exec_prepared(m_first, m_stride);
+    else
+      r = tx.exec_prepared(
+        m_next, m_stride, prepare::make_dynamic_params(m_last_key));
+    tx.commit();
+  }
+
+  // Like icursorstream, only an empty block marks the end.  That way the
+  // caller still gets to process a final, short block.
+  if (r.empty())
+  {
+    m_done = true;
+  }
+  else
+  {
+    auto const last{r.back()};
+    std::vector<std::string> key;
+    key.reserve(m_keys.size());
+    for (auto const &k : m_keys)
+    {
+      auto const f{last[k]};
+      if (f.is_null())
+        throw usage_error{
+          "Keyset column '" + k + "' is null.  Key columns must be non-null."};
+      key.emplace_back(f.c_str(), f.size());
+    }
+    m_last_key = std::move(key);
+  }
+  return r;
+}
@@ -11,15 +11,32 @@
 #include "pqxx-source.hxx"
 
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+
+#if __has_include(<sys/mman.h>)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
 
 extern "C"
 {
 #include <libpq-fe.h>
 }
 
+#include "pqxx/config-internal-libpq.h"
 #include "pqxx/largeobject"
+#include "pqxx/transaction"
 
 #include "pqxx/internal/gates/connection-largeobject.hxx"
 
@@ -58,6 +75,128 @@ constexpr int std_dir_to_pq_dir(std::ios::seekdir dir) noexcept
     default: return dir; break;
     }
 }
+
+
+/// Check a chunk size, and cap it to what libpq can handle in one call.
+std::size_t check_chunk_size(std::size_t chunk_size)
+{
+  if (chunk_size == 0)
+    throw pqxx::argument_error{"Large object chunk size must be positive."};
+  // The lo_read() and lo_write() functions return an int.
+  return std::min(
+    chunk_size, std::size_t(std::numeric_limits<int>::max() / 2 + 1));
+}
+
+
+/// Write data to a large object in chunks, reporting progress.
+void write_chunks(
+  pqxx::largeobjectaccess &obj, char const data[], std::size_t len,
+  std::size_t chunk_size, pqxx::largeobject::progress_callback const &progress)
+{
+  for (std::size_t done{0}; done < len;)
+  {
+    auto const bytes{std::min(chunk_size, len - done)};
+    obj.write(data + done, bytes);
+    done += bytes;
+    if (progress)
+      progress(
+        pqxx::largeobject::size_type(done), pqxx::largeobject::size_type(len));
+  }
+}
+
+
+/// Read a large object's data in chunks, reporting progress.
+/** Stops at the end of the object, or after @c len bytes, whichever comes
+ * first.  Returns the number of bytes read.
+ */
+std::size_t read_chunks(
+  pqxx::largeobjectaccess &obj, char buf[], std::size_t len,
+  std::size_t chunk_size, pqxx::largeobject::progress_callback const &progress)
+{
+  std::size_t done{0};
+  while (done < len)
+  {
+    auto const bytes{
+      obj.read(buf + done, std::min(chunk_size, len - done))};
+    if (bytes == 0)
+      break;
+    done += std::size_t(bytes);
+    if (progress)
+      progress(
+        pqxx::largeobject::size_type(done), pqxx::largeobject::size_type(len));
+  }
+  return done;
+}
+
+
+#if defined(MAP_FAILED)
+/// A memory-mapped local file.  Unmaps the file when it goes out of scope.
+class mapping
+{
+public:
+  mapping(void *data, std::size_t len) noexcept : m_data{data}, m_len{len} {}
+  ~mapping() noexcept { munmap(m_data, m_len); }
+  mapping(mapping const &) = delete;
+  mapping &operator=(mapping const &) = delete;
+
+  char *data() const noexcept { return static_cast<char *>(m_data); }
+  std::size_t size() const noexcept { return m_len; }
+
+private:
+  void *m_data;
+  std::size_t m_len;
+};
+
+
+/// Map a regular, non-empty file into memory for reading.
+/** Returns null if the file can't be mapped, e.g. because it is not a
+ * regular file.  The caller can then fall back to reading it.
+ */
+std::unique_ptr<mapping> map_input(std::string const &file)
+{
+  int const fd{::open(file.c_str(), O_RDONLY)};
+  if (fd < 0)
+    return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 or not S_ISREG(st.st_mode) or st.st_size == 0)
+  {
+    ::close(fd);
+    return nullptr;
+  }
+  auto const len{std::size_t(st.st_size)};
+  void *const data{mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0)};
+  ::close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+  madvise(data, len, MADV_SEQUENTIAL);
+  return std::make_unique<mapping>(data, len);
+}
+
+
+/// Create a file of @c len bytes, and map it into memory for writing.
+/** Returns null if the file can't be mapped, or if @c len is zero.  The
+ * caller can then fall back to writing it.
+ */
+std::unique_ptr<mapping> map_output(std::string const &file, std::size_t len)
+{
+  if (len == 0)
+    return nullptr;
+  int const fd{::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666)};
+  if (fd < 0)
+    return nullptr;
+  if (ftruncate(fd, off_t(len)) != 0)
+  {
+    ::close(fd);
+    return nullptr;
+  }
+  void *const data{
+    mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+  ::close(fd);
+  if (data == MAP_FAILED)
+    return nullptr;
+  return std::make_unique<mapping>(data, len);
+}
+#endif // MAP_FAILED
 } // namespace
 
 
@@ -90,6 +229,49 @@ pqxx::largeobject::largeobject(dbtransaction &t, std::string_view file) :
 }
 
 
+pqxx::largeobject pqxx::largeobject::import_file(
+  dbtransaction &t, std::string_view file, std::size_t chunk_size,
+  progress_callback const &progress)
+{
+  chunk_size = check_chunk_size(chunk_size);
+  std::string const name{file};
+  largeobjectaccess obj{t, std::ios::out | std::ios::binary};
+
+#if defined(MAP_FAILED)
+  if (auto const map{map_input(name)}; map)
+  {
+    write_chunks(obj, map->data(), map->size(), chunk_size, progress);
+    return obj;
+  }
+#endif
+
+  std::ifstream in{name, std::ios::in | std::ios::binary};
+  if (not in)
+    throw failure{"Could not open file '" + name + "' for import."};
+  size_type total{-1};
+  if (in.seekg(0, std::ios::end))
+  {
+    total = size_type(in.tellg());
+    in.seekg(0, std::ios::beg);
+  }
+  in.clear();
+
+  std::unique_ptr<char[]> const buf{new char[chunk_size]};
+  size_type done{0};
+  while (in.read(buf.get(), std::streamsize(chunk_size)) or in.gcount() > 0)
+  {
+    auto const bytes{std::size_t(in.gcount())};
+    obj.write(buf.get(), bytes);
+    done += size_type(bytes);
+    if (progress)
+      progress(done, total);
+  }
+  if (in.bad())
+    throw failure{"Error reading file '" + name + "' for import."};
+  return obj;
+}
+
+
 pqxx::largeobject::largeobject(largeobjectaccess const &o) noexcept :
         m_id{o.id()}
 {}
@@ -110,6 +292,48 @@ void pqxx::largeobject::to_file(dbtransaction &t, std::string_view file) const
 }
 
 
+void pqxx::largeobject::export_file(
+  dbtransaction &t, std::string_view file, std::size_t chunk_size,
+  progress_callback const &progress) const
+{
+  chunk_size = check_chunk_size(chunk_size);
+  std::string const name{file};
+  largeobjectaccess obj{t, id(), std::ios::in | std::ios::binary};
+  auto const total{obj.seek(0, std::ios::end)};
+  obj.seek(0, std::ios::beg);
+
+#if defined(MAP_FAILED)
+  if (auto const map{map_output(name, std::size_t(total))}; map)
+  {
+    if (read_chunks(obj, map->data(), map->size(), chunk_size, progress) <
+        map->size())
+      throw failure{"Large object #" + to_string(id()) +
+                    " shrank while exporting it to '" + name + "'."};
+    return;
+  }
+#endif
+
+  std::ofstream out{name, std::ios::out | std::ios::binary | std::ios::trunc};
+  if (not out)
+    throw failure{"Could not open file '" + name + "' for export."};
+  std::unique_ptr<char[]> const buf{new char[chunk_size]};
+  size_type done{0};
+  for (;;)
+  {
+    auto const bytes{obj.read(buf.get(), chunk_size)};
+    if (bytes == 0)
+      break;
+    out.write(buf.get(), std::streamsize(bytes));
+    done += bytes;
+    if (progress)
+      progress(done, total);
+  }
+  out.close();
+  if (not out)
+    throw failure{"Error writing to file '" + name + "'."};
+}
+
+
 void pqxx::largeobject::remove(dbtransaction &t) const
 {
   if (lo_unlink(raw_connection(t), id()) == -1)
@@ -301,3 +525,431 @@ void pqxx::largeobjectaccess::process_notice(std::string const &s) noexcept
 {
   m_trans.process_notice(s);
 }
+
+
+pqxx::internal::lo_read_ahead::lo_read_ahead(
+  dbtransaction &t, int fd, std::size_t chunk_size, int depth) :
+        namedclass{"lo_read_ahead"},
+        transactionfocus{t},
+        m_conn{largeobject::raw_connection(t)},
+        m_fd{to_string(fd)},
+        m_chunk_text{to_string(chunk_size)},
+        m_chunk_size{chunk_size},
+        m_depth{depth}
+{
+  if (depth <= 0)
+    throw range_error{"Large object read-ahead depth must be positive."};
+  register_me();
+  try
+  {
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+    m_pipeline = (depth > 1 and PQenterPipelineMode(m_conn) == 1);
+#endif
+    send();
+    while (m_pipeline and m_in_flight < m_depth) send();
+  }
+  catch (std::exception const &)
+  {
+    try
+    {
+      stop();
+    }
+    catch (std::exception const &)
+    {}
+    if (registered())
+      unregister_me();
+    throw;
+  }
+}
+
+
+pqxx::internal::lo_read_ahead::~lo_read_ahead() noexcept
+{
+  try
+  {
+    stop();
+  }
+  catch (std::exception const &e)
+  {
+    reg_pending_error(e.what());
+  }
+  if (registered())
+    unregister_me();
+}
+
+
+void pqxx::internal::lo_read_ahead::send()
+{
+  char const *const values[]{m_fd.c_str(), m_chunk_text.c_str()};
+  if (
+    PQsendQueryParams(
+      m_conn, "SELECT pg_catalog.loread($1::integer, $2::integer)", 2,
+      nullptr, values, nullptr, nullptr, 1) != 1)
+    throw failure{"Could not send large object read: " +
+                  std::string{PQerrorMessage(m_conn)}};
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  // Ask the server to send the result right away, without waiting for a sync.
+  if (m_pipeline and (PQsendFlushRequest(m_conn) != 1 or PQflush(m_conn) != 0))
+    throw failure{"Could not send large object read: " +
+                  std::string{PQerrorMessage(m_conn)}};
+#endif
+  ++m_in_flight;
+}
+
+
+std::size_t pqxx::internal::lo_read_ahead::receive(char buf[])
+{
+  --m_in_flight;
+  std::unique_ptr<PGresult, void (*)(PGresult *)> const r{
+    PQgetResult(m_conn), PQclear};
+  // Each query's results end in a null.
+  while (auto const extra{PQgetResult(m_conn)}) PQclear(extra);
+  if (not r or PQresultStatus(r.get()) != PGRES_TUPLES_OK)
+    throw failure{
+      "Error reading large object: " +
+      std::string{r ? PQresultErrorMessage(r.get()) : PQerrorMessage(m_conn)}};
+  auto const len{std::size_t(PQgetlength(r.get(), 0, 0))};
+  if (len > m_chunk_size)
+    throw internal_error{"Large object read returned too much data."};
+  if (buf != nullptr)
+    std::memcpy(buf, PQgetvalue(r.get(), 0, 0), len);
+  return len;
+}
+
+
+std::size_t pqxx::internal::lo_read_ahead::read(char buf[])
+{
+  if (m_in_flight == 0)
+    return 0;
+  std::size_t got;
+  try
+  {
+    got = receive(buf);
+  }
+  catch (std::exception const &)
+  {
+    // Don't leave the connection in pipeline mode with results unread.
+    try
+    {
+      stop();
+    }
+    catch (std::exception const &)
+    {}
+    throw;
+  }
+  if (got < m_chunk_size)
+    m_eof = true;
+  if (m_eof)
+    stop();
+  else
+    send();
+  return got;
+}
+
+
+std::size_t pqxx::internal::lo_read_ahead::stop()
+{
+  // Once one read fails, the ones after it in the pipeline get aborted.
+  // Consume all their results anyway, and report the first error.
+  std::size_t ahead{0};
+  std::exception_ptr error;
+  while (m_in_flight > 0)
+  {
+    try
+    {
+      ahead += receive(nullptr);
+    }
+    catch (std::exception const &)
+    {
+      if (not error)
+        error = std::current_exception();
+    }
+  }
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  if (m_pipeline)
+  {
+    m_pipeline = false;
+    if (PQpipelineSync(m_conn) == 1)
+    {
+      std::unique_ptr<PGresult, void (*)(PGresult *)> const sync{
+        PQgetResult(m_conn), PQclear};
+    }
+    else if (not error)
+    {
+      error = std::make_exception_ptr(failure{
+        "Could not end pipeline: " + std::string{PQerrorMessage(m_conn)}});
+    }
+    PQexitPipelineMode(m_conn);
+  }
+#endif
+  if (registered())
+    unregister_me();
+  if (error)
+    std::rethrow_exception(error);
+  return ahead;
+}
+
+namespace
+{
+/// Shared state for a parallel large-object transfer.
+class parallel_transfer
+{
+public:
+  using size_type = pqxx::large_object_size_type;
+
+  parallel_transfer(size_type total, std::size_t chunk_size) :
+          m_total{total},
+          m_chunk_size{chunk_size}
+  {}
+
+  /// Claim the next chunk.  Returns false when there is no more work.
+  bool claim(size_type &offset, std::size_t &len) noexcept
+  {
+    if (m_failed)
+      return false;
+    offset = m_next.fetch_add(size_type(m_chunk_size));
+    if (offset >= m_total)
+      return false;
+    len = std::size_t(std::min(size_type(m_chunk_size), m_total - offset));
+    return true;
+  }
+
+  /// Run @c body on each connection, in a thread of its own.
+  /** Rethrows the first exception that any of the threads threw.
+   */
+  template<typename BODY>
+  void run(std::vector<pqxx::connection *> const &conns, BODY const &body)
+  {
+    std::vector<std::thread> threads;
+    try
+    {
+      for (auto const c : conns)
+        threads.emplace_back([this, c, &body] {
+          try
+          {
+            body(*c);
+          }
+          catch (...)
+          {
+            fail(std::current_exception());
+          }
+        });
+    }
+    catch (...)
+    {
+      fail(std::current_exception());
+    }
+    for (auto &t : threads) t.join();
+    if (m_error)
+      std::rethrow_exception(m_error);
+  }
+
+  /// Serialises calls to user callbacks.
+  std::mutex &lock() noexcept { return m_lock; }
+
+private:
+  void fail(std::exception_ptr err) noexcept
+  {
+    std::lock_guard<std::mutex> const guard{m_lock};
+    if (not m_error)
+      m_error = err;
+    m_failed = true;
+  }
+
+  size_type const m_total;
+  std::size_t const m_chunk_size;
+  std::atomic<size_type> m_next{0};
+  std::atomic<bool> m_failed{false};
+  std::mutex m_lock;
+  std::exception_ptr m_error;
+};
+
+
+std::vector<pqxx::connection *>
+check_connections(std::vector<pqxx::connection *> conns)
+{
+  if (conns.empty())
+    throw pqxx::argument_error{"Parallel large object transfer needs at "
+                               "least one connection."};
+  for (auto const c : conns)
+    if (c == nullptr)
+      throw pqxx::argument_error{
+        "Null connection for parallel large object transfer."};
+  return conns;
+}
+} // namespace
+
+
+pqxx::parallel_largeobject_reader::parallel_largeobject_reader(
+  std::vector<connection *> conns, largeobject obj, std::size_t chunk_size) :
+        m_conns{check_connections(std::move(conns))},
+        m_obj{obj},
+        m_chunk_size{check_chunk_size(chunk_size)}
+{}
+
+
+pqxx::parallel_largeobject_reader::size_type
+pqxx::parallel_largeobject_reader::size()
+{
+  if (m_size < 0)
+  {
+    read_transaction tx{*m_conns.front()};
+    m_size = largeobjectaccess{tx, m_obj, std::ios::in | std::ios::binary}
+               .seek(0, std::ios::end);
+    tx.commit();
+  }
+  return m_size;
+}
+
+
+void pqxx::parallel_largeobject_reader::read(sink const &out)
+{
+  parallel_transfer work{size(), m_chunk_size};
+  work.run(m_conns, [this, &work, &out](connection &c) {
+    read_transaction tx{c};
+    // One round trip per chunk.  The binary result format saves us the
+    // work of encoding and decoding the bytea.
+    internal::gate::connection_largeobject gate{c};
+    size_type offset;
+    std::size_t len;
+    while (work.claim(offset, len))
+    {
+      auto const r{gate.exec_params(
+        "SELECT pg_catalog.lo_get($1::oid, $2::bigint, $3::integer)",
+        internal::params{m_obj.id(), offset, len}, format::binary)};
+      auto const data{r.at(0).at(0).view()};
+      std::lock_guard<std::mutex> const guard{work.lock()};
+      out(offset, data);
+    }
+    tx.commit();
+  });
+}
+
+
+void pqxx::parallel_largeobject_reader::read_to_file(std::string_view file)
+{
+  std::string const name{file};
+  auto const total{size()};
+
+#if defined(MAP_FAILED)
+  if (auto const map{map_output(name, std::size_t(total))}; map)
+  {
+    read([&map](size_type offset, std::string_view data) {
+      std::memcpy(map->data() + offset, data.data(), data.size());
+    });
+    return;
+  }
+#endif
+
+  std::ofstream out{name, std::ios::out | std::ios::binary | std::ios::trunc};
+  if (not out)
+    throw failure{"Could not open file '" + name + "' for writing."};
+  read([&out](size_type offset, std::string_view data) {
+    out.seekp(std::streamoff(offset));
+    out.write(data.data(), std::streamsize(data.size()));
+  });
+  out.close();
+  if (not out)
+    throw failure{"Error writing to file '" + name + "'."};
+}
+
+
+std::string pqxx::parallel_largeobject_reader::read_all()
+{
+  std::string data;
+  data.resize(std::size_t(size()));
+  read([&data](size_type offset, std::string_view chunk) {
+    chunk.copy(data.data() + offset, chunk.size());
+  });
+  return data;
+}
+
+
+pqxx::parallel_largeobject_writer::parallel_largeobject_writer(
+  std::vector<connection *> conns, largeobject obj, std::size_t chunk_size) :
+        m_conns{check_connections(std::move(conns))},
+        m_obj{obj},
+        m_chunk_size{check_chunk_size(chunk_size)}
+{}
+
+
+void pqxx::parallel_largeobject_writer::write_chunks(
+  size_type total, fill_function const &fill)
+{
+  if (total < 0)
+    throw argument_error{"Negative size for large object write."};
+
+  {
+    // INV_WRITE is 0x20000.
+    work tx{*m_conns.front()};
+    tx.exec1(
+      "SELECT lo_truncate64(lo_open(" + to_string(m_obj.id()) +
+      ", 131072), " + to_string(total) + ")");
+    tx.commit();
+  }
+
+  parallel_transfer work{total, m_chunk_size};
+  work.run(m_conns, [this, &work, &fill](connection &c) {
+    pqxx::work tx{c};
+    // One round trip per chunk, with the data as a binary parameter.
+    internal::gate::connection_largeobject gate{c};
+    std::unique_ptr<char[]> const buf{new char[m_chunk_size]};
+    size_type offset;
+    std::size_t len;
+    while (work.claim(offset, len))
+    {
+      auto const data{fill(offset, buf.get(), len)};
+      gate.exec_params(
+        "SELECT pg_catalog.lo_put($1::oid, $2::bigint, $3::bytea)",
+        internal::params{m_obj.id(), offset, binarystring{data, len}},
+        format::text);
+    }
+    tx.commit();
+  });
+}
+
+
+void pqxx::parallel_largeobject_writer::write(
+  size_type total, source const &in)
+{
+  std::mutex lock;
+  write_chunks(
+    total, [&in, &lock](size_type offset, char buf[], std::size_t len) {
+      std::lock_guard<std::mutex> const guard{lock};
+      in(offset, buf, len);
+      return static_cast<char const *>(buf);
+    });
+}
+
+
+void pqxx::parallel_largeobject_writer::write(std::string_view data)
+{
+  write_chunks(
+    size_type(data.size()), [data](size_type offset, char[], std::size_t) {
+      return data.data() + offset;
+    });
+}
+
+
+void pqxx::parallel_largeobject_writer::write_file(std::string_view file)
+{
+  std::string const name{file};
+
+#if defined(MAP_FAILED)
+  if (auto const map{map_input(name)}; map)
+  {
+    write(std::string_view{map->data(), map->size()});
+    return;
+  }
+#endif
+
+  std::ifstream in{name, std::ios::in | std::ios::binary};
+  if (not in or not in.seekg(0, std::ios::end))
+    throw failure{"Could not open file '" + name + "' for reading."};
+  auto const total{size_type(in.tellg())};
+  write(total, [&in, &name](size_type offset, char buf[], std::size_t len) {
+    in.seekg(std::streamoff(offset));
+    if (not in.read(buf, std::streamsize(len)))
+      throw failure{"Error reading file '" + name + "'."};
+  });
+}
@@ -0,0 +1,427 @@
+/** Implementation of the pqxx::parallel_executor class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "pqxx/nontransaction"
+#include "pqxx/parallel_executor"
+#include "pqxx/pipeline"
+
+#include "pqxx/internal/gates/pipeline-parallel_executor.hxx"
+
+
+namespace
+{
+/// Statement timeout value meaning "we don't know what it is."
+constexpr long unknown_timeout{-1};
+
+
+/// Resets a connection's statement timeout when a worker is done with it.
+/** This happens even if the worker fails, so that the pool never hands out
+ * a connection with a timeout still set.  If the reset fails, the guard
+ * closes the connection instead, and the pool drops it.
+ *
+ * Destroy any transaction on the connection before the guard.
+ */
+class timeout_reset
+{
+public:
+  timeout_reset(pqxx::connection &c, long const &timeout) noexcept :
+          m_conn{c}, m_timeout{timeout}
+  {}
+  timeout_reset(timeout_reset const &) = delete;
+  timeout_reset &operator=(timeout_reset const &) = delete;
+
+  ~timeout_reset() noexcept
+  {
+    if (m_timeout == 0)
+      return;
+    try
+    {
+      pqxx::nontransaction tx{m_conn};
+      tx.exec0("RESET statement_timeout");
+    }
+    catch (std::exception const &)
+    {
+      try
+      {
+        m_conn.close();
+      }
+      catch (std::exception const &)
+      {}
+    }
+  }
+
+private:
+  pqxx::connection &m_conn;
+  /// The worker's idea of the current timeout: 0 for the default.
+  long const &m_timeout;
+};
+} // namespace
+
+
+/// Hands out tasks to worker threads, with work stealing.
+class pqxx::parallel_executor::scheduler
+{
+public:
+  scheduler(
+    parallel_executor &home, std::vector<outcome> &out, std::size_t workers,
+    std::chrono::steady_clock::time_point start) :
+          m_home{home}, m_out{out}, m_done(out.size(), 0), m_start{start}
+  {
+    // Give each worker a contiguous block of tasks.
+    auto const n{out.size()};
+    for (std::size_t w{0}; w < workers; ++w)
+    {
+      auto q{std::make_unique<queue>()};
+      for (auto i{w * n / workers}; i < (w + 1) * n / workers; ++i)
+        q->items.push_back(i);
+      m_queues.push_back(std::move(q));
+    }
+  }
+
+  /// Run worker number @c w.
+  void work(std::size_t w) noexcept
+  {
+    try
+    {
+      // Take work before taking a connection.  There may be none left.
+      std::vector<std::size_t> chunk;
+      if (not take(w, chunk))
+        return;
+      auto lease{connect(w, chunk)};
+      if (not lease)
+        return;
+      try
+      {
+        long timeout{0};
+        timeout_reset const reset{*lease, timeout};
+        nontransaction tx{*lease};
+        do
+        {
+          try
+          {
+            run_chunk(tx, chunk, timeout);
+          }
+          catch (std::exception const &)
+          {
+            // Leave this chunk's unfinished tasks for the other workers.
+            put_back(w, chunk);
+            throw;
+          }
+        } while (take_or_leave(w, chunk));
+      }
+      catch (std::exception const &)
+      {
+        leave();
+        throw;
+      }
+    }
+    catch (std::exception const &)
+    {
+      std::lock_guard<std::mutex> lock{m_error_mutex};
+      m_error = std::current_exception();
+    }
+  }
+
+  /// Give any tasks that no worker could do the last worker error.
+  void finish()
+  {
+    for (std::size_t i{0}; i < m_done.size(); ++i)
+      if (not m_done[i])
+        m_out[i].error =
+          m_error ? m_error :
+                    std::make_exception_ptr(failure{"No worker ran query."});
+  }
+
+private:
+  /// Get a connection for worker @c w, which holds the tasks in @c chunk.
+  /** If the pool has no connection to spare, but other workers have one,
+   * this leaves @c chunk for them to steal and returns an empty lease.  Some
+   * other thread, such as the one calling @c run(), may be holding on to the
+   * pool's connections, so waiting for one could take forever.
+   *
+   * Only while no worker has a connection does this keep trying.
+   */
+  connection_pool::lease connect(std::size_t w, std::vector<std::size_t> &chunk)
+  {
+    using priority = connection_pool::priority;
+    std::chrono::milliseconds wait{0};
+    for (;;)
+    {
+      try
+      {
+        auto lease{m_home.m_pool.acquire(priority::normal, wait)};
+        std::lock_guard<std::mutex> lock{m_state_mutex};
+        ++m_connected;
+        return lease;
+      }
+      catch (pool_exhausted const &)
+      {}
+      catch (std::exception const &)
+      {
+        put_back(w, chunk);
+        throw;
+      }
+      std::lock_guard<std::mutex> lock{m_state_mutex};
+      if (m_connected > 0)
+      {
+        put_back(w, chunk);
+        return {};
+      }
+      wait = std::chrono::milliseconds{10};
+    }
+  }
+
+  /// Like @c take(), but if there's no work left, stop being connected.
+  /** A connected worker only stops while holding the state lock, so that a
+   * worker which left its tasks to connected workers never strands them.
+   */
+  bool take_or_leave(std::size_t w, std::vector<std::size_t> &chunk)
+  {
+    if (take(w, chunk))
+      return true;
+    std::lock_guard<std::mutex> lock{m_state_mutex};
+    if (take(w, chunk))
+      return true;
+    --m_connected;
+    return false;
+  }
+
+  /// A connected worker stops, after a failure.
+  void leave() noexcept
+  {
+    std::lock_guard<std::mutex> lock{m_state_mutex};
+    --m_connected;
+  }
+
+  struct queue
+  {
+    std::mutex mutex;
+    std::deque<std::size_t> items;
+  };
+
+  /// Get the next few tasks for worker @c w.  Returns false when all done.
+  bool take(std::size_t w, std::vector<std::size_t> &chunk)
+  {
+    auto const depth{m_home.m_depth};
+    {
+      auto &own{*m_queues[w]};
+      std::lock_guard<std::mutex> lock{own.mutex};
+      while (chunk.size() < depth and not own.items.empty())
+      {
+        chunk.push_back(own.items.front());
+        own.items.pop_front();
+      }
+    }
+    if (not chunk.empty())
+      return true;
+
+    // Nothing left of our own.  Steal half of someone else's, from the back.
+    for (std::size_t i{1}; i < m_queues.size(); ++i)
+    {
+      auto &other{*m_queues[(w + i) % m_queues.size()]};
+      std::lock_guard<std::mutex> lock{other.mutex};
+      auto const steal{std::min(depth, (other.items.size() + 1) / 2)};
+      for (std::size_t s{0}; s < steal; ++s)
+      {
+        chunk.push_back(other.items.back());
+        other.items.pop_back();
+      }
+      if (not chunk.empty())
+      {
+        std::reverse(std::begin(chunk), std::end(chunk));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Put unfinished tasks from @c chunk back at the front of @c w's queue.
+  void put_back(std::size_t w, std::vector<std::size_t> const &chunk)
+  {
+    auto &own{*m_queues[w]};
+    std::lock_guard<std::mutex> lock{own.mutex};
+    for (auto i{chunk.rbegin()}; i != chunk.rend(); ++i)
+      if (not m_done[*i])
+        own.items.push_front(*i);
+  }
+
+  void finish_task(std::size_t i, result &&r)
+  {
+    m_out[i].res = std::move(r);
+    m_done[i] = 1;
+  }
+
+  void fail_task(std::size_t i, std::exception_ptr err)
+  {
+    m_out[i].error = std::move(err);
+    m_done[i] = 1;
+  }
+
+  /// Pipeline the tasks in @c chunk, and collect their outcomes.
+  /** Each query, including any change to the statement timeout, runs in its
+   * own implicit transaction.  So a failing query does not roll back the
+   * others, nor the timeout setting.  Empties @c chunk, unless it throws.
+   */
+  void run_chunk(
+    transaction_base &tx, std::vector<std::size_t> &chunk, long &timeout)
+  {
+    auto const now{std::chrono::steady_clock::now()};
+    pipeline pipe{tx};
+    internal::gate::pipeline_parallel_executor gate{pipe};
+    gate.isolate();
+    pipe.retain(static_cast<int>(2 * chunk.size() + 1));
+
+    // For each query in the pipeline: its task, or npos for a SET.
+    constexpr auto npos{static_cast<std::size_t>(-1)};
+    std::vector<std::pair<std::size_t, pipeline::query_id>> ids;
+    for (auto i : chunk)
+    {
+      auto &t{m_home.m_tasks[i]};
+      long want{0};
+      if (t.timeout.count() > 0)
+      {
+        want = static_cast<long>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            m_start + t.timeout - now)
+            .count());
+        if (want <= 0)
+        {
+          fail_task(
+            i, std::make_exception_ptr(sql_error{
+                 "Query timed out before it could start.", t.query, "57014"}));
+          continue;
+        }
+      }
+      if (want != timeout)
+      {
+        ids.emplace_back(
+          npos, pipe.insert(
+                  (want == 0) ? std::string{"RESET statement_timeout"} :
+                                "SET statement_timeout = " + to_string(want)));
+        timeout = want;
+      }
+
+      std::unique_ptr<internal::params> args;
+      if (t.args)
+        args = std::make_unique<internal::params>(std::as_const(*t.args));
+      ids.emplace_back(i, gate.insert(t.query, std::move(args)));
+    }
+    pipe.complete();
+
+    for (auto const &[i, id] : ids)
+    {
+      try
+      {
+        auto r{pipe.retrieve(id)};
+        if (i != npos)
+          finish_task(i, std::move(r));
+      }
+      catch (broken_connection const &)
+      {
+        throw;
+      }
+      catch (std::exception const &)
+      {
+        // Only a lost connection makes one query's failure affect another.
+        if (not tx.conn().is_open())
+          throw broken_connection{};
+        if (i != npos)
+        {
+          fail_task(i, std::current_exception());
+          continue;
+        }
+        timeout = unknown_timeout;
+        throw;
+      }
+    }
+    chunk.clear();
+  }
+
+  parallel_executor &m_home;
+  std::vector<outcome> &m_out;
+  /// Per task: is it done?  Each task is only ever touched by one worker.
+  std::vector<char> m_done;
+  std::chrono::steady_clock::time_point const m_start;
+  std::vector<std::unique_ptr<queue>> m_queues;
+
+  /// Guards @c m_connected, and the decision to stop or to leave work.
+  std::mutex m_state_mutex;
+  /// Number of workers holding a connection.
+  std::size_t m_connected = 0;
+
+  std::mutex m_error_mutex;
+  std::exception_ptr m_error;
+};
+
+
+pqxx::parallel_executor::parallel_executor(
+  connection_pool &pool, std::size_t threads, std::size_t depth) :
+        m_pool{pool},
+        m_threads{(threads == 0) ? pool.max_size() : threads},
+        m_depth{depth}
+{
+  if (depth == 0)
+    throw range_error{"Parallel executor needs a pipeline depth of 1+."};
+}
+
+
+pqxx::parallel_executor::~parallel_executor() noexcept = default;
+
+
+std::size_t pqxx::parallel_executor::add_task(
+  std::string &&query, std::unique_ptr<internal::params> args)
+{
+  m_tasks.push_back(task{std::move(query), std::move(args)});
+  return m_tasks.size() - 1;
+}
+
+
+void pqxx::parallel_executor::set_timeout(
+  std::size_t task, std::chrono::milliseconds timeout)
+{
+  if (timeout.count() < 0)
+    throw range_error{"Negative query timeout."};
+  m_tasks.at(task).timeout = timeout;
+}
+
+
+std::vector<pqxx::parallel_executor::outcome> pqxx::parallel_executor::run()
+{
+  std::vector<outcome> out(m_tasks.size());
+  if (m_tasks.empty())
+    return out;
+
+  auto const workers{std::min(m_threads, m_tasks.size())};
+  scheduler sched{*this, out, workers, std::chrono::steady_clock::now()};
+  std::vector<std::thread> threads;
+  threads.reserve(workers);
+  try
+  {
+    for (std::size_t w{0}; w < workers; ++w)
+      threads.emplace_back([&sched, w] { sched.work(w); });
+  }
+  catch (std::exception const &)
+  {
+    // Couldn't start all threads.  The ones we have will steal the work.
+    if (threads.empty())
+      throw;
+  }
+  for (auto &t : threads) t.join();
+  sched.finish();
+
+  m_tasks.clear();
+  return out;
+}
@@ -10,11 +10,18 @@
  */
 #include "pqxx-source.hxx"
 
+#include <algorithm>
 #include <iterator>
+#include <memory>
 
+extern "C"
+{
+#include <libpq-fe.h>
+}
+
+#include "pqxx/config-internal-libpq.h"
 #include "pqxx/dbtransaction"
 #include "pqxx/pipeline"
-#include "pqxx/separated_list"
 
 #include "pqxx/internal/gates/connection-pipeline.hxx"
 #include "pqxx/internal/gates/result-creation.hxx"
@@ -26,12 +33,26 @@ namespace
 std::string const theSeparator{"; "};
 std::string const theDummyValue{"1"};
 std::string const theDummyQuery{"SELECT " + theDummyValue + theSeparator};
+
+
+/// Sets a flag for as long as it exists, however it goes out of scope.
+class flag_setter
+{
+public:
+  explicit flag_setter(bool &flag) noexcept : m_flag{flag} { m_flag = true; }
+  flag_setter(flag_setter const &) = delete;
+  flag_setter &operator=(flag_setter const &) = delete;
+  ~flag_setter() noexcept { m_flag = false; }
+
+private:
+  bool &m_flag;
+};
 } // namespace
 
 
 void pqxx::pipeline::init()
 {
-  m_issuedrange = make_pair(m_queries.end(), m_queries.end());
+  m_issuedrange = std::make_pair(end_id(), end_id());
   attach();
 }
 
@@ -62,18 +83,29 @@ void pqxx::pipeline::detach()
 }
 
 
-pqxx::pipeline::query_id pqxx::pipeline::insert(std::string_view q)
+pqxx::pipeline::query_id pqxx::pipeline::insert_query(
+  query_kind kind, std::string_view q, std::unique_ptr<internal::params> args)
 {
   attach();
   query_id const qid{generate_id()};
-  auto const i{m_queries.insert(std::make_pair(qid, Query(q))).first};
 
-  if (m_issuedrange.second == m_queries.end())
+  // A sync only separates queries that use the extended query protocol.
+  if (m_isolated and kind == query_kind::text)
   {
-    m_issuedrange.second = i;
-    if (m_issuedrange.first == m_queries.end())
-      m_issuedrange.first = i;
+    kind = query_kind::params;
+    args = std::make_unique<internal::params>();
   }
+
+  // Store the text in the arena, followed by a separator.  Any plain-text
+  // queries still waiting to be issued are contiguous in the arena, and thus
+  // form a batch.  (For a prepared statement, the text is its name.)
+  auto const begin{m_text.size()};
+  m_text.append(q);
+  m_text.append(theSeparator);
+  m_queries.emplace_back(begin, q.size(), kind, std::move(args));
+
+  // The new query automatically falls in the not-yet-issued range, which
+  // extends up to end_id().
   m_num_waiting++;
 
   if (m_num_waiting > m_retain)
@@ -84,6 +116,7 @@ pqxx::pipeline::query_id pqxx::pipeline::insert(std::string_view q)
       issue();
   }
 
+  dispatch();
   return qid;
 }
 
@@ -92,12 +125,13 @@ void pqxx::pipeline::complete()
 {
   if (have_pending())
     receive(m_issuedrange.second);
-  if (m_num_waiting and (m_error == qid_limit()))
+  while (m_num_waiting and (m_error == qid_limit()))
   {
     issue();
-    receive(m_queries.end());
+    receive(m_issuedrange.second);
   }
   detach();
+  dispatch();
 }
 
 
@@ -107,10 +141,11 @@ void pqxx::pipeline::flush()
   {
     if (have_pending())
       receive(m_issuedrange.second);
-    m_issuedrange.first = m_issuedrange.second = m_queries.end();
+    dispatch();
+    m_issuedrange.first = m_issuedrange.second = end_id();
     m_num_waiting = 0;
     m_dummy_pending = false;
-    m_queries.clear();
+    clear_queries();
   }
   detach();
 }
@@ -118,23 +153,33 @@ void pqxx::pipeline::flush()
 
 void pqxx::pipeline::cancel()
 {
-  while (have_pending())
+  bool const pipelined{m_pipeline_mode};
+  if (pipelined)
   {
+    // In pipeline mode, we must read the batch to the end before the
+    // connection is usable again.
     pqxx::internal::gate::connection_pipeline(m_trans.conn()).cancel_query();
-    auto canceled_query{m_issuedrange.first};
+    drain_pipelined_batch();
+  }
+
+  while (have_pending())
+  {
+    if (not pipelined)
+      pqxx::internal::gate::connection_pipeline(m_trans.conn()).cancel_query();
+    auto const canceled_query{m_issuedrange.first};
     ++m_issuedrange.first;
-    m_queries.erase(canceled_query);
+    retire(canceled_query);
   }
 }
 
 
 bool pqxx::pipeline::is_finished(pipeline::query_id q) const
 {
-  if (m_queries.find(q) == m_queries.end())
+  if (find_query(q) == nullptr)
     throw std::logic_error{"Requested status for unknown query '" +
                            to_string(q) + "'."};
-  return (QueryMap::const_iterator(m_issuedrange.first) == m_queries.end()) or
-         (q < m_issuedrange.first->first and q < m_error);
+  return (m_issuedrange.first == end_id()) or
+         (q < m_issuedrange.first and q < m_error);
 }
 
 
@@ -142,7 +187,8 @@ std::pair<pqxx::pipeline::query_id, pqxx::result> pqxx::pipeline::retrieve()
 {
   if (m_queries.empty())
     throw std::logic_error{"Attempt to retrieve result from empty pipeline."};
-  return retrieve(std::begin(m_queries));
+  // The front of the table is never a retired query.
+  return retrieve_query(m_front_id);
 }
 
 
@@ -154,6 +200,7 @@ int pqxx::pipeline::retain(int retain_max)
 
   int const oldvalue{m_retain};
   m_retain = retain_max;
+  m_adaptive = false;
 
   if (m_num_waiting >= m_retain)
     resume();
@@ -171,12 +218,184 @@ void pqxx::pipeline::resume()
     issue();
     receive_if_available();
   }
+  dispatch();
+}
+
+
+void pqxx::pipeline::on_complete(query_id qid, completion_handler handler)
+{
+  auto const q{find_query(qid)};
+  if (q == nullptr)
+    throw std::logic_error{
+      "Attempt to set completion handler for unknown query."};
+
+  if (q->on_done)
+    --m_num_handlers;
+  q->on_done = std::move(handler);
+  if (q->on_done)
+    ++m_num_handlers;
+  m_dispatch_from = std::min(m_dispatch_from, qid);
+}
+
+
+std::future<pqxx::result> pqxx::pipeline::get_future(query_id qid)
+{
+  // A completion_handler must be copyable, so share the promise.
+  auto const promise{std::make_shared<std::promise<result>>()};
+  auto future{promise->get_future()};
+  on_complete(qid, [promise](query_id, result const &r, std::exception_ptr e) {
+    if (e)
+      promise->set_exception(e);
+    else
+      promise->set_value(r);
+  });
+  return future;
+}
+
+
+void pqxx::pipeline::dispatch()
+{
+  // A handler may call back into the pipeline.  Don't recurse.
+  if (m_dispatching)
+    return;
+  flag_setter const dispatching{m_dispatching};
+
+  // Results come in in query order, so the finished queries form a range
+  // at the front.  Queries beyond an error will never complete, and once
+  // they are no longer pending, that counts as finished as well.
+  auto qid{std::max(m_dispatch_from, m_front_id)};
+  while (m_num_handlers > 0 and qid < end_id())
+  {
+    bool const failed{qid >= m_error};
+    if (qid >= m_issuedrange.first)
+    {
+      if (qid < m_issuedrange.second or m_error >= end_id())
+        break;
+      if (not failed)
+      {
+        qid = m_error;
+        continue;
+      }
+    }
+
+    auto const q{find_query(qid)};
+    ++qid;
+    m_dispatch_from = qid;
+    if (q == nullptr or not q->on_done)
+      continue;
+
+    completion_handler handler;
+    std::swap(handler, q->on_done);
+    --m_num_handlers;
+    result const r{q->res};
+    retire(qid - 1);
+
+    std::exception_ptr err;
+    if (failed)
+      err = std::make_exception_ptr(std::runtime_error{
+        "Could not complete query in pipeline due to error in earlier "
+        "query."});
+    else
+      try
+      {
+        pqxx::internal::gate::result_creation{r}.check_status();
+      }
+      catch (std::exception const &)
+      {
+        err = std::current_exception();
+      }
+    handler(qid - 1, r, err);
+  }
+}
+
+
+void pqxx::pipeline::retain_adaptive(int min_retain, int max_retain)
+{
+  if (min_retain < 0)
+    throw range_error{"Attempt to make pipeline retain " +
+                      to_string(min_retain) + " queries"};
+  if (max_retain < min_retain)
+    throw range_error{"Adaptive pipeline retention has maximum " +
+                      to_string(max_retain) + " below minimum " +
+                      to_string(min_retain) + "."};
+
+  m_adaptive = true;
+  m_min_retain = min_retain;
+  m_max_retain = max_retain;
+  m_retain =
+    m_have_per_query ? std::clamp(m_retain, min_retain, max_retain) :
+                       min_retain;
+
+  if (m_num_waiting >= m_retain)
+    resume();
+}
+
+
+void pqxx::pipeline::note_result() noexcept
+{
+  if (m_batch_queries == 0)
+    return;
+
+  auto const now{std::chrono::steady_clock::now()};
+  if (not m_batch_started)
+  {
+    m_batch_first = now;
+    m_batch_started = true;
+  }
+  if (have_pending())
+    return;
+
+  // That completes the batch.
+  m_last_batch.queries = m_batch_queries;
+  m_last_batch.first_result = m_batch_first - m_batch_start;
+  m_last_batch.last_result = now - m_batch_start;
+
+  using seconds = std::chrono::duration<double>;
+  auto const first{seconds{m_last_batch.first_result}.count()};
+  auto const last{seconds{m_last_batch.last_result}.count()};
+
+  // Smooth out the noise with an exponentially weighted moving average.
+  constexpr double weight{0.25};
+  if (m_batch_queries > 1)
+  {
+    // Results after the first one arrive as the backend executes them.
+    auto const per_query{(last - first) / (m_batch_queries - 1)};
+    m_per_query = m_have_per_query ?
+                    (1 - weight) * m_per_query + weight * per_query :
+                    per_query;
+    m_have_per_query = true;
+  }
+  // The first result also includes the time to execute the first query.
+  auto const round_trip{std::max(first - m_per_query, 0.0)};
+  m_round_trip = m_have_round_trip ?
+                   (1 - weight) * m_round_trip + weight * round_trip :
+                   round_trip;
+  m_have_round_trip = true;
+  m_batch_queries = 0;
+
+  if (m_adaptive and not m_have_per_query)
+  {
+    // Without a time per query, we can't tell how many queries fit into a
+    // round trip.  Don't hold queries back on a guess.
+    m_retain = m_min_retain;
+  }
+  else if (m_adaptive)
+  {
+    // Keep enough queries in a batch to keep the backend busy while the
+    // next batch is on its way.
+    auto const per_query{std::max(m_per_query, 1e-6)};
+    auto const target{m_round_trip / per_query};
+    m_retain = (target >= m_max_retain) ?
+                 m_max_retain :
+                 std::max(static_cast<int>(target), m_min_retain);
+  }
 }
 
 
 pqxx::pipeline::query_id pqxx::pipeline::generate_id()
 {
-  if (m_q_id == qid_limit())
+  // Leave room for end_id(), and keep qid_limit() free to mean "no error."
+  if (m_q_id >= qid_limit() - 1)
     throw std::overflow_error{"Too many queries went through pipeline."};
   ++m_q_id;
   return m_q_id;
@@ -193,25 +412,50 @@ void pqxx::pipeline::issue()
     return;
 
   // Start with oldest query (lowest id) not in previous issue range.
-  auto oldest{m_issuedrange.second};
-
-  // Construct cumulative query string for entire batch.
-  auto cum{separated_list(
-    theSeparator, oldest, m_queries.end(),
-    [](QueryMap::const_iterator i) { return i->second.get_query(); })};
-  auto const num_issued{
-    QueryMap::size_type(std::distance(oldest, m_queries.end()))};
-  bool const prepend_dummy{num_issued > 1};
-  if (prepend_dummy)
-    cum = theDummyQuery + cum;
-
-  pqxx::internal::gate::connection_pipeline{m_trans.conn()}.start_exec(
-    cum.c_str());
+  auto const oldest{m_issuedrange.second};
+  auto const end{end_id()};
+
+  // A batch is either a run of plain-text queries, or a run of queries using
+  // the extended query protocol.  The two don't mix.
+  bool const text{query_at(oldest).kind == query_kind::text};
+  auto stop{oldest + 1};
+  while (stop != end and (query_at(stop).kind == query_kind::text) == text)
+    ++stop;
+
+  bool prepend_dummy{false};
+  if (text)
+  {
+    // Construct cumulative query string for entire batch.  The queries sit
+    // back to back in the text arena, separators and all, so all we need to
+    // do is copy that stretch (minus the final separator).
+    prepend_dummy = (stop - oldest > 1);
+    auto const batch_begin{query_at(oldest).text_begin};
+    auto const batch_end{
+      (stop == end) ? m_text.size() : query_at(stop).text_begin};
+    auto const batch_size{batch_end - theSeparator.size() - batch_begin};
+    std::string cum;
+    cum.reserve((prepend_dummy ? theDummyQuery.size() : 0) + batch_size);
+    if (prepend_dummy)
+      cum = theDummyQuery;
+    cum.append(m_text, batch_begin, batch_size);
+
+    share_texts(oldest, stop);
+    pqxx::internal::gate::connection_pipeline{m_trans.conn()}.start_exec(
+      cum.c_str());
+  }
+  else
+  {
+    stop = issue_extended(oldest, stop);
+  }
+  auto const num_issued{stop - oldest};
 
   // Since we managed to send out these queries, update state to reflect this.
+  m_batch_start = std::chrono::steady_clock::now();
+  m_batch_started = false;
+  m_batch_queries = check_cast<int>(num_issued, "pipeline issue()");
   m_dummy_pending = prepend_dummy;
   m_issuedrange.first = oldest;
-  m_issuedrange.second = m_queries.end();
+  m_issuedrange.second = stop;
   m_num_waiting -= check_cast<int>(num_issued, "pipeline issue()");
 }
 
@@ -223,39 +467,225 @@ void pqxx::pipeline::internal_error(std::string const &err)
 }
 
 
+void pqxx::pipeline::share_texts(query_id begin, query_id end)
+{
+  auto texts{std::make_shared<std::vector<std::string>>()};
+  texts->reserve(static_cast<std::size_t>(end - begin));
+  for (auto qid{begin}; qid != end; ++qid)
+    texts->emplace_back(text_of(query_at(qid)));
+  m_batch_texts = std::move(texts);
+  m_batch_first_id = begin;
+}
+
+
+pqxx::pipeline::query_id
+pqxx::pipeline::issue_extended(query_id begin, query_id end)
+{
+  pqxx::internal::gate::connection_pipeline gate{m_trans.conn()};
+  auto const send{[this, &gate](query_id qid) {
+    auto const &q{query_at(qid)};
+    auto const text{
+      (*m_batch_texts)[static_cast<std::size_t>(qid - m_batch_first_id)]
+        .c_str()};
+    if (q.kind == query_kind::prepared)
+      gate.start_exec_prepared(text, *q.args);
+    else
+      gate.start_exec_params(text, *q.args);
+  }};
+
+  // Without libpq's pipeline mode, we can only send one query at a time.
+  if (end - begin == 1 or not gate.enter_pipeline_mode())
+  {
+    share_texts(begin, begin + 1);
+    send(begin);
+    return begin + 1;
+  }
+
+  share_texts(begin, end);
+
+  m_pipeline_mode = true;
+  m_syncs_pending = 0;
+  try
+  {
+    for (auto qid{begin}; qid != end; ++qid)
+    {
+      send(qid);
+      if (m_isolated)
+      {
+        gate.pipeline_sync();
+        ++m_syncs_pending;
+      }
+    }
+    if (not m_isolated)
+    {
+      gate.pipeline_sync();
+      ++m_syncs_pending;
+    }
+  }
+  catch (std::exception const &)
+  {
+    m_pipeline_mode = false;
+    gate.exit_pipeline_mode();
+    throw;
+  }
+  return end;
+}
+
+
 bool pqxx::pipeline::obtain_result(bool expect_none)
 {
+  if (m_pipeline_mode)
+    return obtain_pipelined_result();
+
   pqxx::internal::gate::connection_pipeline gate{m_trans.conn()};
   auto const r{gate.get_result()};
   if (r == nullptr)
   {
     if (have_pending() and not expect_none)
     {
-      set_error_at(m_issuedrange.first->first);
+      set_error_at(m_issuedrange.first);
       m_issuedrange.second = m_issuedrange.first;
     }
     return false;
   }
 
-  result const res{pqxx::internal::gate::result_creation::create(
-    r, std::begin(m_queries)->second.get_query(),
-    internal::enc_group(m_trans.conn().encoding_id()))};
-
   if (not have_pending())
   {
-    set_error_at(std::begin(m_queries)->first);
+    internal::clear_result(r);
+    set_error_at(m_front_id);
     throw std::logic_error{
       "Got more results from pipeline than there were queries."};
   }
 
   // Must be the result for the oldest pending query.
-  if (not m_issuedrange.first->second.get_result().empty())
+  auto &q{query_at(m_issuedrange.first)};
+  result const res{pqxx::internal::gate::result_creation::create(
+    r, batch_text(m_issuedrange.first),
+    internal::enc_group(m_trans.conn().encoding_id()))};
+
+  if (not q.res.empty())
     internal_error("Multiple results for one query.");
 
-  m_issuedrange.first->second.set_result(res);
+  q.res = res;
   ++m_issuedrange.first;
+  note_result();
+
+  return true;
+}
+
+
+bool pqxx::pipeline::obtain_pipelined_result()
+{
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  pqxx::internal::gate::connection_pipeline gate{m_trans.conn()};
+  auto const r{gate.get_result()};
+  if (r == nullptr)
+  {
+    // Lost the connection, most likely.
+    if (have_pending())
+    {
+      set_error_at(m_issuedrange.first);
+      m_issuedrange.second = m_issuedrange.first;
+    }
+    m_pipeline_mode = false;
+    gate.exit_pipeline_mode();
+    return false;
+  }
+
+  auto const status{PQresultStatus(r)};
+  if (status == PGRES_PIPELINE_SYNC)
+  {
+    internal::clear_result(r);
+    // In isolated mode, each query has its own sync.  That does not end the
+    // batch, but it does end the query's implicit transaction.
+    if (--m_syncs_pending > 0)
+      return true;
+
+    // End of the batch.
+    m_pipeline_mode = false;
+    if (not gate.exit_pipeline_mode())
+      internal_error("Could not leave libpq pipeline mode.");
+    if (have_pending())
+    {
+      set_error_at(m_issuedrange.first);
+      m_issuedrange.second = m_issuedrange.first;
+    }
+    return false;
+  }
+
+  if (not have_pending())
+  {
+    internal::clear_result(r);
+    internal_error("Got more results from pipeline than there were queries.");
+  }
+
+  auto const qid{m_issuedrange.first};
+  auto &q{query_at(qid)};
+  if (status == PGRES_PIPELINE_ABORTED)
+  {
+    // An earlier query in the batch failed, so this one never ran.
+    internal::clear_result(r);
+    set_error_at(qid);
+  }
+  else
+  {
+    q.res = pqxx::internal::gate::result_creation::create(
+      r, batch_text(qid),
+      internal::enc_group(m_trans.conn().encoding_id()));
+    // The server skips the rest of the failed query's sync segment.
+    if (status == PGRES_FATAL_ERROR and not m_isolated)
+      set_error_at(qid + 1);
+  }
+  ++m_issuedrange.first;
+  note_result();
+
+  // In pipeline mode, each query's results end in a null result.
+  auto const extra{gate.get_result()};
+  if (extra != nullptr)
+  {
+    internal::clear_result(extra);
+    internal_error("Multiple results for one query.");
+  }
+
+  // Once the last query is in, don't keep the sync marker waiting.  We can't
+  // send anything else until we've read it anyway.
+  if (not have_pending())
+    obtain_pipelined_result();
 
   return true;
+#else
+  internal_error("Pipeline mode is not supported.");
+#endif // PQXX_HAVE_PQ_PIPELINE
+}
+
+
+void pqxx::pipeline::drain_pipelined_batch() noexcept
+{
+#if defined(PQXX_HAVE_PQ_PIPELINE)
+  pqxx::internal::gate::connection_pipeline gate{m_trans.conn()};
+
+  // Each remaining query's results end in a null result, and the batch ends
+  // in its last sync marker.  If we see more nulls than that, the connection
+  // must have broken.
+  auto nulls{m_issuedrange.second - m_issuedrange.first};
+  for (;;)
+  {
+    auto const r{gate.get_result()};
+    if (r == nullptr)
+    {
+      if (nulls-- <= 0)
+        break;
+      continue;
+    }
+    bool const sync{PQresultStatus(r) == PGRES_PIPELINE_SYNC};
+    internal::clear_result(r);
+    if (sync and --m_syncs_pending <= 0)
+      break;
+  }
+  gate.exit_pipeline_mode();
+#endif // PQXX_HAVE_PQ_PIPELINE
+  m_pipeline_mode = false;
+  m_syncs_pending = 0;
 }
 
 
@@ -291,6 +721,7 @@ void pqxx::pipeline::obtain_dummy()
 
     if (R.at(0).at(0).as<std::string>() != theDummyValue)
       internal_error("Dummy query in pipeline returned unexpected value.");
+    note_result();
     return;
   }
 
@@ -304,7 +735,7 @@ void pqxx::pipeline::obtain_dummy()
   // First, give the whole batch the same syntax error message, in case all
   // else is going to fail.
   for (auto i{m_issuedrange.first}; i != m_issuedrange.second; ++i)
-    i->second.set_result(R);
+    query_at(i).res = R;
 
   // Remember where the end of this batch was
   auto const stop{m_issuedrange.second};
@@ -313,8 +744,8 @@ void pqxx::pipeline::obtain_dummy()
   obtain_result(true);
 
   // Reset internal state to forget botched batch attempt
-  m_num_waiting += check_cast<int>(
-    std::distance(m_issuedrange.first, stop), "pipeline obtain_dummy()");
+  m_num_waiting +=
+    check_cast<int>(stop - m_issuedrange.first, "pipeline obtain_dummy()");
   m_issuedrange.second = m_issuedrange.first;
 
   // Issue queries in failed batch one at a time.
@@ -324,38 +755,43 @@ void pqxx::pipeline::obtain_dummy()
     do
     {
       m_num_waiting--;
-      auto const query{*m_issuedrange.first->second.get_query()};
-      result const res{m_trans.exec(query)};
-      m_issuedrange.first->second.set_result(res);
+      auto &q{query_at(m_issuedrange.first)};
+      result const res{m_trans.exec(text_of(q))};
+      q.res = res;
       pqxx::internal::gate::result_creation{res}.check_status();
       ++m_issuedrange.first;
     } while (m_issuedrange.first != stop);
   }
   catch (std::exception const &)
   {
-    auto const thud{m_issuedrange.first->first};
+    auto const thud{m_issuedrange.first};
     ++m_issuedrange.first;
     m_issuedrange.second = m_issuedrange.first;
-    auto q{m_issuedrange.first};
-    set_error_at((q == m_queries.end()) ? thud + 1 : q->first);
+    set_error_at(thud + 1);
   }
 }
 
 
 std::pair<pqxx::pipeline::query_id, pqxx::result>
-pqxx::pipeline::retrieve(pipeline::QueryMap::iterator q)
+pqxx::pipeline::retrieve_query(query_id qid)
 {
-  if (q == m_queries.end())
+  auto const q{find_query(qid)};
+  if (q == nullptr)
     throw std::logic_error{"Attempt to retrieve result for unknown query."};
 
-  if (q->first >= m_error)
+  // Retrieving the result yourself overrides any completion handler.
+  if (q->on_done)
+  {
+    q->on_done = nullptr;
+    --m_num_handlers;
+  }
+
+  if (qid >= m_error)
     throw std::runtime_error{
       "Could not complete query in pipeline due to error in earlier query."};
 
-  // If query hasn't issued yet, do it now.
-  if (
-    m_issuedrange.second != m_queries.end() and
-    (q->first >= m_issuedrange.second->first))
+  // If query hasn't issued yet, do it now.  It may take more than one batch.
+  while (qid >= m_issuedrange.second and m_error == qid_limit())
   {
     if (have_pending())
       receive(m_issuedrange.second);
@@ -366,19 +802,13 @@ pqxx::pipeline::retrieve(pipeline::QueryMap::iterator q)
   // If result not in yet, get it; else get at least whatever's convenient.
   if (have_pending())
   {
-    if (q->first >= m_issuedrange.first->first)
-    {
-      auto suc{q};
-      ++suc;
-      receive(suc);
-    }
+    if (qid >= m_issuedrange.first)
+      receive(qid + 1);
     else
-    {
       receive_if_available();
-    }
   }
 
-  if (q->first >= m_error)
+  if (qid >= m_error)
     throw std::runtime_error{
       "Could not complete query in pipeline due to error in earlier query."};
 
@@ -386,13 +816,16 @@ pqxx::pipeline::retrieve(pipeline::QueryMap::iterator q)
   if (m_num_waiting and not have_pending() and (m_error == qid_limit()))
     issue();
 
-  result const R{q->second.get_result()};
-  auto const P{std::make_pair(q->first, R)};
+  dispatch();
+  if (find_query(qid) == nullptr)
+    throw std::logic_error{
+      "Query result was retrieved by a completion handler."};
 
-  m_queries.erase(q);
+  result const R{query_at(qid).res};
+  retire(qid);
 
   pqxx::internal::gate::result_creation{R}.check_status();
-  return P;
+  return std::make_pair(qid, R);
 }
 
 
@@ -420,16 +853,83 @@ void pqxx::pipeline::receive_if_available()
 }
 
 
-void pqxx::pipeline::receive(pipeline::QueryMap::const_iterator stop)
+void pqxx::pipeline::receive(query_id stop)
 {
   if (m_dummy_pending)
     obtain_dummy();
 
-  while (obtain_result() and
-         QueryMap::const_iterator{m_issuedrange.first} != stop)
+  while (obtain_result() and m_issuedrange.first != stop)
     ;
 
   // Also haul in any remaining "targets of opportunity".
-  if (QueryMap::const_iterator{m_issuedrange.first} == stop)
+  if (m_issuedrange.first == stop)
     get_further_available_results();
 }
+
+
+pqxx::pipeline::Query *pqxx::pipeline::find_query(query_id qid) noexcept
+{
+  if (qid < m_front_id or qid >= end_id())
+    return nullptr;
+  auto &q{query_at(qid)};
+  return q.retired ? nullptr : &q;
+}
+
+
+pqxx::pipeline::Query const *pqxx::pipeline::find_query(query_id qid) const
+  noexcept
+{
+  if (qid < m_front_id or qid >= end_id())
+    return nullptr;
+  auto const &q{
+    m_queries[static_cast<QueryTable::size_type>(qid - m_front_id)]};
+  return q.retired ? nullptr : &q;
+}
+
+
+void pqxx::pipeline::retire(query_id qid) noexcept
+{
+  auto &q{query_at(qid)};
+  q.retired = true;
+  q.res.clear();
+  if (q.on_done)
+  {
+    q.on_done = nullptr;
+    --m_num_handlers;
+  }
+
+  // Drop retired entries off the front, so the front is always live.
+  while (not m_queries.empty() and m_queries.front().retired)
+  {
+    m_queries.pop_front();
+    ++m_front_id;
+  }
+
+  if (m_queries.empty())
+  {
+    // Keep the arena's capacity around for the next batch.
+    m_text.clear();
+    return;
+  }
+
+  // If the pipeline never runs empty, the arena keeps growing at the back
+  // while its front is dead weight.  Shift the live part down once the dead
+  // part dominates, so that this costs amortised constant time per query.
+  constexpr std::size_t min_compaction{4096};
+  auto const dead{m_queries.front().text_begin};
+  if (dead >= min_compaction and dead >= m_text.size() - dead)
+  {
+    m_text.erase(0, dead);
+    for (auto &entry : m_queries) entry.text_begin -= dead;
+  }
+}
+
+
+void pqxx::pipeline::clear_queries() noexcept
+{
+  m_queries.clear();
+  m_text.clear();
+  m_batch_texts.reset();
+  m_front_id = end_id();
+  m_num_handlers = 0;
+}
@@ -292,6 +292,85 @@ char const *pqxx::result::cmd_status() const noexcept
 }
 
 
+pqxx::result
+pqxx::result::copy_rows(size_type begin, size_type end) const
+{
+  auto const src{const_cast<internal::pq::PGresult *>(m_data.get())};
+  auto const copy{PQcopyResult(
+    src, PG_COPYRES_ATTRS | PG_COPYRES_EVENTS | PG_COPYRES_NOTICEHOOKS)};
+  if (copy == nullptr)
+    throw std::bad_alloc{};
+  result const r{copy, m_query, m_encoding};
+
+  auto const cols{columns()};
+  for (auto row{begin}; row < end; ++row)
+    for (row_size_type col{0}; col < cols; ++col)
+    {
+      bool const null{PQgetisnull(src, row, col) != 0};
+      auto const ok{PQsetvalue(
+        copy, row - begin, col, null ? nullptr : PQgetvalue(src, row, col),
+        null ? -1 : PQgetlength(src, row, col))};
+      if (ok == 0)
+        throw std::bad_alloc{};
+    }
+  return r;
+}
+
+
+pqxx::result pqxx::result::concat(std::vector<result> const &parts)
+{
+  if (std::empty(parts))
+    return result{};
+  auto const &first{parts.front()};
+  auto const cols{first.columns()};
+  for (auto const &part : parts)
+  {
+    if (part.columns() != cols)
+      throw argument_error{
+        "Cannot merge results with different numbers of columns."};
+    for (row_size_type col{0}; col < cols; ++col)
+    {
+      std::string_view const name{first.column_name(col)};
+      if (part.column_name(col) != name)
+        throw argument_error{
+          "Cannot merge results: column " + to_string(col) +
+          " has different names, '" + std::string{name} + "' and '" +
+          part.column_name(col) + "'."};
+      if (part.column_type(col) != first.column_type(col))
+        throw argument_error{
+          "Cannot merge results: column '" + std::string{name} +
+          "' has different types."};
+    }
+  }
+  if (std::size(parts) == 1)
+    return first;
+
+  auto const copy{PQcopyResult(
+    const_cast<internal::pq::PGresult *>(first.m_data.get()),
+    PG_COPYRES_ATTRS | PG_COPYRES_EVENTS | PG_COPYRES_NOTICEHOOKS)};
+  if (copy == nullptr)
+    throw std::bad_alloc{};
+  result const r{copy, first.m_query, first.m_encoding};
+
+  int out{0};
+  for (auto const &part : parts)
+  {
+    auto const src{const_cast<internal::pq::PGresult *>(part.m_data.get())};
+    for (size_type row{0}; row < part.size(); ++row, ++out)
+      for (row_size_type col{0}; col < cols; ++col)
+      {
+        bool const null{PQgetisnull(src, row, col) != 0};
+        auto const ok{PQsetvalue(
+          copy, out, col, null ? nullptr : PQgetvalue(src, row, col),
+          null ? -1 : PQgetlength(src, row, col))};
+        if (ok == 0)
+          throw std::bad_alloc{};
+      }
+  }
+  return r;
+}
+
+
 std::string const &pqxx::result::query() const noexcept
 {
   return (m_query.get() == nullptr) ? s_empty_string : *m_query;
@@ -358,6 +437,13 @@ pqxx::row::size_type pqxx::result::column_number(char const col_name[]) const
 }
 
 
+pqxx::format pqxx::result::column_format(row::size_type col_num) const
+  noexcept
+{
+  return static_cast<format>(PQfformat(m_data.get(), col_num));
+}
+
+
 pqxx::oid pqxx::result::column_table(row::size_type col_num) const
 {
   oid const t{PQftable(m_data.get(), col_num)};
@@ -10,17 +10,26 @@
  */
 #include "pqxx-source.hxx"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <stdexcept>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "pqxx/connection"
 #include "pqxx/nontransaction"
 #include "pqxx/result"
 #include "pqxx/robusttransaction"
 
+#include "pqxx/internal/lookup_batcher.hxx"
+
 
 namespace
 {
@@ -58,19 +67,148 @@ std::unordered_map<std::string, tx_stat, initial_hash> const statuses{
 };
 
 
-tx_stat query_status(std::string const &xid, std::string const &conn_str)
+/// Finds out what happened to in-doubt transactions on one database.
+/** When a server goes down, many transactions may lose their connections at
+ * the same time.  Rather than have each of them hammer the server (or its
+ * replacement) with connection attempts, they share one resolver per
+ * connection string.  The resolver keeps a single side connection, and checks
+ * the statuses of all transactions that are waiting for an answer in one
+ * query.
+ */
+class in_doubt_resolver
+{
+public:
+  explicit in_doubt_resolver(std::string const &conn_str) :
+          m_conn_str{conn_str},
+          m_batcher{[this](std::vector<std::string> const &xids) {
+            return query(xids);
+          }}
+  {}
+
+  /// Get the shared resolver for the database at @c conn_str.
+  static std::shared_ptr<in_doubt_resolver> get(std::string const &conn_str)
+  {
+    static std::mutex lock;
+    static std::map<std::string, std::weak_ptr<in_doubt_resolver>> resolvers;
+    std::lock_guard<std::mutex> const guard{lock};
+    auto &slot{resolvers[conn_str]};
+    auto resolver{slot.lock()};
+    if (not resolver)
+    {
+      resolver = std::make_shared<in_doubt_resolver>(conn_str);
+      slot = resolver;
+    }
+    return resolver;
+  }
+
+  /// Query a transaction's status.
+  /** Returns @c tx_unknown if the database could not be reached.
+   *
+   * If another thread is already querying, this waits for it to finish, and
+   * then checks this transaction along with any others that are waiting.
+   */
+  tx_stat check(std::string const &xid) { return m_batcher.get(xid); }
+
+private:
+  using answers = pqxx::internal::lookup_batcher<tx_stat>::answers;
+
+  /// Parse status string as returned by txid_status().
+  static tx_stat parse_status(pqxx::field const &f)
+  {
+    // Null means the transaction is too old to tell.
+    if (f.is_null())
+      return tx_unknown;
+    auto const status_text{f.as<std::string>()};
+    if (status_text.empty())
+      throw pqxx::internal_error{"Transaction status string is empty."};
+    auto const here{statuses.find(status_text)};
+    if (here == statuses.end())
+      throw pqxx::internal_error{
+        "Unknown transaction status: " + status_text};
+    return here->second;
+  }
+
+  /// Query statuses for @c xids.  Only one thread at a time calls this.
+  answers query(std::vector<std::string> const &xids)
+  {
+    static std::string const name{"robusttxck"};
+    answers outcome;
+    try
+    {
+      if (not m_conn or not m_conn->is_open())
+      {
+        m_conn.reset();
+        m_conn = std::make_unique<pqxx::connection>(m_conn_str);
+      }
+      std::string list;
+      for (auto const &xid : xids)
+      {
+        if (not list.empty())
+          list += ',';
+        list += xid;
+      }
+      pqxx::nontransaction w{*m_conn, name};
+      try
+      {
+        auto const r{w.exec(
+          "SELECT x, txid_status(x) "
+          "FROM unnest(" +
+          w.quote("{" + list + "}") + "::bigint[]) AS x")};
+        for (auto const &row : r)
+          outcome[row[0].as<std::string>()].value = parse_status(row[1]);
+      }
+      catch (pqxx::sql_error const &)
+      {
+        // One of the transaction IDs may be bad, e.g. "in the future" after
+        // failing over to a replica that was behind.  Check them one by one,
+        // so each transaction gets its own answer.
+        for (auto const &xid : xids)
+        {
+          try
+          {
+            outcome[xid].value =
+              parse_status(w.exec1("SELECT txid_status(" + xid + ")")[0]);
+          }
+          catch (pqxx::broken_connection const &)
+          {
+            throw;
+          }
+          catch (std::exception const &)
+          {
+            outcome[xid].error = std::current_exception();
+          }
+        }
+      }
+    }
+    catch (pqxx::broken_connection const &)
+    {
+      // Leave the statuses unknown.  Callers will retry.
+      m_conn.reset();
+      outcome.clear();
+    }
+    return outcome;
+  }
+
+  std::string const m_conn_str;
+  /// Side connection.  Only the querying thread may touch this.
+  std::unique_ptr<pqxx::connection> m_conn;
+  pqxx::internal::lookup_batcher<tx_stat> m_batcher;
+};
+
+
+/// Sleep for a randomised, exponentially growing interval.
+/** Each call doubles @c delay, up to @c max_delay, and then sleeps for a
+ * random time between half of @c delay and the full @c delay.  The jitter
+ * keeps waiting clients from acting in lockstep.
+ */
+void back_off(
+  std::chrono::milliseconds &delay, std::chrono::milliseconds max_delay)
 {
-  static std::string const name{"robusttxck"};
-  auto const query{"SELECT txid_status(" + xid + ")"};
-  pqxx::connection c{conn_str};
-  pqxx::nontransaction w{c, name};
-  auto const status_text{w.query_value<std::string>(query)};
-  if (status_text.empty())
-    throw pqxx::internal_error{"Transaction status string is empty."};
-  auto const here{statuses.find(status_text)};
-  if (here == statuses.end())
-    throw pqxx::internal_error{"Unknown transaction status: " + status_text};
-  return here->second;
+  thread_local std::minstd_rand rng{std::random_device{}()};
+  std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter{
+    delay.count() / 2, delay.count()};
+  std::this_thread::sleep_for(std::chrono::milliseconds{jitter(rng)});
+  delay = std::min(delay * 2, max_delay);
 }
 } // namespace
 
@@ -92,6 +230,9 @@ pqxx::internal::basic_robusttransaction::~basic_robusttransaction() = default;
 
 void pqxx::internal::basic_robusttransaction::do_commit()
 {
+  // The commit releases all savepoints, so no need to do that separately.
+  drop_deferred_releases(0);
+
   // Check constraints before sending the COMMIT to the database, so as to
   // minimise our in-doubt window.
   try
@@ -138,29 +279,23 @@ void pqxx::internal::basic_robusttransaction::do_commit()
 
   // If we get here, we're in doubt.  Figure out what happened.
 
-  auto const delay{std::chrono::milliseconds(300)};
-  int const max_attempts{500};
-  static_assert(max_attempts > 0);
+  // Back off exponentially, with jitter, between attempts.  During a
+  // failover, many clients may be doing this at the same time.
+  std::chrono::milliseconds delay{50};
+  auto const max_delay{std::chrono::milliseconds{5000}};
+  auto const deadline{
+    std::chrono::steady_clock::now() + std::chrono::seconds{150}};
+  auto const resolver{in_doubt_resolver::get(m_conn_string)};
 
-  tx_stat stat;
-  for (int attempts{0}; attempts < max_attempts;
-       ++attempts, std::this_thread::sleep_for(delay))
+  for (; std::chrono::steady_clock::now() < deadline;
+       back_off(delay, max_delay))
   {
-    stat = tx_unknown;
-    try
-    {
-      stat = query_status(m_xid, m_conn_string);
-    }
-    catch (pqxx::broken_connection const &)
-    {
-      // Swallow the error.  Pause and retry.
-    }
-    switch (stat)
+    switch (resolver->check(m_xid))
     {
     case tx_unknown:
       // We were unable to reconnect and query transaction status.
       // Stay in it for another attempt.
-      return;
+      break;
     case tx_committed:
       // Success!  We're done.
       return;
@@ -191,5 +326,7 @@ void pqxx::internal::basic_robusttransaction::do_commit()
 
 void pqxx::internal::basic_robusttransaction::do_abort()
 {
+  // We sent the BEGIN right away, so anything queued is ours.
+  discard_deferred();
   direct_exec("ROLLBACK");
 }
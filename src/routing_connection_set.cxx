@@ -0,0 +1,166 @@
+/** Implementation of the pqxx::routing_connection_set class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <algorithm>
+#include <thread>
+
+#include "pqxx/nontransaction"
+#include "pqxx/routing_connection_set"
+
+
+namespace
+{
+/// Has the server at the other end of @c c replayed WAL up to @c lsn?
+/** A server that is not in recovery is a primary, so it's always caught up.
+ */
+bool caught_up(pqxx::connection &c, std::string const &lsn)
+{
+  pqxx::nontransaction tx{c};
+  return tx
+    .exec_params1(
+      "SELECT CASE WHEN pg_is_in_recovery() "
+      "THEN coalesce(pg_last_wal_replay_lsn() >= $1::pg_lsn, false) "
+      "ELSE true END",
+      lsn)[0]
+    .as<bool>();
+}
+} // namespace
+
+
+pqxx::routing_connection_set::routing_connection_set(
+  std::string primary, std::vector<std::string> const &replicas,
+  std::size_t pool_size) :
+        m_primary{std::move(primary), pool_size}
+{
+  m_replicas.reserve(replicas.size());
+  for (auto const &r : replicas)
+    m_replicas.push_back(std::make_unique<replica>(r, pool_size));
+}
+
+
+pqxx::routing_connection_set::~routing_connection_set() noexcept = default;
+
+
+void pqxx::routing_connection_set::set_retry_interval(
+  std::chrono::milliseconds interval)
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_retry_interval = interval;
+}
+
+
+bool pqxx::routing_connection_set::healthy(std::size_t n) const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_replicas.at(n)->down_until <= clock::now();
+}
+
+
+std::vector<pqxx::routing_connection_set::replica *>
+pqxx::routing_connection_set::candidates() const
+{
+  std::vector<std::pair<std::size_t, replica *>> loads;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto const now{clock::now()};
+    for (auto const &r : m_replicas)
+      if (r->down_until <= now)
+        loads.emplace_back(r->pool.in_use(), r.get());
+  }
+  std::stable_sort(
+    std::begin(loads), std::end(loads),
+    [](auto const &a, auto const &b) { return a.first < b.first; });
+
+  std::vector<replica *> out;
+  out.reserve(loads.size());
+  for (auto const &[load, r] : loads) out.push_back(r);
+  return out;
+}
+
+
+pqxx::connection_pool::lease
+pqxx::routing_connection_set::try_replica(replica &r)
+{
+  try
+  {
+    // Don't wait for a saturated replica; the next one may have room.
+    return r.pool.acquire(
+      connection_pool::priority::normal, std::chrono::milliseconds{0});
+  }
+  catch (pool_exhausted const &)
+  {
+    return {};
+  }
+  catch (broken_connection const &)
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    r.down_until = clock::now() + m_retry_interval;
+    return {};
+  }
+}
+
+
+pqxx::connection_pool::lease pqxx::routing_connection_set::read()
+{
+  for (auto r : candidates())
+  {
+    auto l{try_replica(*r)};
+    if (l)
+      return l;
+  }
+  return m_primary.acquire();
+}
+
+
+pqxx::connection_pool::lease pqxx::routing_connection_set::read(
+  std::string const &lsn, std::chrono::milliseconds timeout)
+{
+  auto const deadline{clock::now() + timeout};
+  std::chrono::milliseconds delay{5};
+  auto const max_delay{std::chrono::milliseconds{200}};
+
+  for (;;)
+  {
+    for (auto r : candidates())
+    {
+      auto l{try_replica(*r)};
+      if (not l)
+        continue;
+      try
+      {
+        if (caught_up(*l, lsn))
+          return l;
+      }
+      catch (broken_connection const &)
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        r->down_until = clock::now() + m_retry_interval;
+      }
+    }
+
+    auto const now{clock::now()};
+    if (now >= deadline)
+      break;
+    std::this_thread::sleep_for(std::min(
+      std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now) +
+        std::chrono::milliseconds{1},
+      delay));
+    delay = std::min(delay * 2, max_delay);
+  }
+  // No replica caught up in time.  The primary has the data.
+  return m_primary.acquire();
+}
+
+
+std::string pqxx::routing_connection_set::wal_position(connection &primary)
+{
+  nontransaction tx{primary};
+  return tx.query_value<std::string>("SELECT pg_current_wal_lsn()");
+}
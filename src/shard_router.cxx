@@ -0,0 +1,132 @@
+/** Implementation of the pqxx::shard_router class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <cstdint>
+#include <future>
+
+#include "pqxx/nontransaction"
+#include "pqxx/shard_router"
+
+#include "pqxx/internal/gates/result-shard_router.hxx"
+
+
+pqxx::shard_router::shard_router(
+  std::vector<std::string> const &shards, shard_function shard_of,
+  std::size_t pool_size) :
+        m_shard_of{std::move(shard_of)}
+{
+  if (std::empty(shards))
+    throw argument_error{"A shard_router needs at least one shard."};
+  if (not m_shard_of)
+    m_shard_of = hash_shards(std::size(shards));
+  m_pools.reserve(std::size(shards));
+  for (auto const &options : shards)
+    m_pools.push_back(std::make_unique<connection_pool>(options, pool_size));
+}
+
+
+pqxx::shard_router::~shard_router() noexcept = default;
+
+
+pqxx::shard_router::shard_function
+pqxx::shard_router::hash_shards(std::size_t n)
+{
+  if (n == 0)
+    throw argument_error{"Cannot hash keys to zero shards."};
+  return [n](std::string_view key) {
+    // 64-bit FNV-1a: cheap, and the same everywhere.
+    std::uint64_t hash{0xcbf29ce484222325u};
+    for (auto const c : key)
+    {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 0x100000001b3u;
+    }
+
+    // Jump consistent hash, as described by Lamping & Veach.
+    std::int64_t bucket{-1}, jump{0};
+    while (jump < static_cast<std::int64_t>(n))
+    {
+      bucket = jump;
+      hash = hash * 2862933555777941757u + 1;
+      jump = static_cast<std::int64_t>(
+        static_cast<double>(bucket + 1) *
+        (static_cast<double>(std::int64_t{1} << 31) /
+         static_cast<double>((hash >> 33) + 1)));
+    }
+    return static_cast<std::size_t>(bucket);
+  };
+}
+
+
+std::size_t pqxx::shard_router::pick(std::string_view key) const
+{
+  auto const n{m_shard_of(key)};
+  if (n >= size())
+    throw range_error{
+      "Shard function returned shard " + to_string(n) + ", but there are " +
+      to_string(size()) + " shards."};
+  return n;
+}
+
+
+pqxx::connection_pool &pqxx::shard_router::shard(std::size_t n)
+{
+  if (n >= size())
+    throw range_error{
+      "Shard number " + to_string(n) + " out of range; there are " +
+      to_string(size()) + " shards."};
+  return *m_pools[n];
+}
+
+
+void pqxx::shard_router::prepare(
+  std::string const &name, std::string const &definition)
+{
+  for (auto &pool : m_pools) pool->prepare(name, definition);
+}
+
+
+std::vector<pqxx::result> pqxx::shard_router::for_each_shard(
+  shard_task const &task, connection_pool::priority p)
+{
+  std::vector<std::future<result>> pending;
+  pending.reserve(size());
+  for (std::size_t n{0}; n < size(); ++n)
+    pending.push_back(std::async(std::launch::async, [this, &task, p, n] {
+      auto lease{m_pools[n]->acquire(p)};
+      nontransaction tx{*lease};
+      return task(tx, n);
+    }));
+
+  std::vector<result> results;
+  results.reserve(size());
+  std::exception_ptr error;
+  for (auto &f : pending)
+  {
+    try
+    {
+      results.push_back(f.get());
+    }
+    catch (...)
+    {
+      if (not error)
+        error = std::current_exception();
+    }
+  }
+  if (error)
+    std::rethrow_exception(error);
+  return results;
+}
+
+
+pqxx::result pqxx::shard_router::merge(std::vector<result> const &parts)
+{
+  return internal::gate::result_shard_router::concat(parts);
+}
@@ -0,0 +1,98 @@
+/** Implementation of the pqxx::single_flight class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include "pqxx/nontransaction"
+#include "pqxx/single_flight"
+
+
+pqxx::single_flight::single_flight(connection_pool &pool) : m_pool{pool} {}
+
+
+pqxx::single_flight::~single_flight() noexcept = default;
+
+
+std::string pqxx::single_flight::make_key(
+  char kind, std::string_view text, internal::params const &args)
+{
+  // Lengths go in front of variable-length data, so that no two different
+  // queries can come out the same.
+  std::string key;
+  key.push_back(kind);
+  key += to_string(text.size());
+  key.push_back(':');
+  key += text;
+  auto const pointers{args.get_pointers()};
+  for (std::size_t i{0}; i < pointers.size(); ++i)
+  {
+    if (pointers[i] == nullptr)
+    {
+      key.push_back('N');
+      continue;
+    }
+    auto const len{static_cast<std::size_t>(args.lengths[i])};
+    key.push_back(args.binaries[i] ? 'B' : 'T');
+    key += to_string(len);
+    key.push_back(':');
+    key.append(pointers[i], len);
+  }
+  return key;
+}
+
+
+pqxx::result pqxx::single_flight::coalesce(
+  std::string &&key, std::function<result(transaction_base &)> const &run)
+{
+  std::promise<result> promise;
+  std::shared_future<result> existing;
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    auto const found{m_in_flight.find(key)};
+    if (found == m_in_flight.end())
+      m_in_flight.emplace(key, promise.get_future().share());
+    else
+      existing = found->second;
+  }
+
+  if (existing.valid())
+  {
+    // Someone's already running this query.  Wait for their result.
+    ++m_coalesced;
+    return existing.get();
+  }
+
+  // We're the one to run it.
+  std::exception_ptr error;
+  result r;
+  try
+  {
+    ++m_executions;
+    auto lease{m_pool.acquire()};
+    nontransaction tx{*lease};
+    r = run(tx);
+  }
+  catch (...)
+  {
+    error = std::current_exception();
+  }
+
+  // Stop new callers from joining in before we publish the outcome, so that
+  // nobody gets a result from before they called.
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_in_flight.erase(key);
+  }
+  if (error)
+  {
+    promise.set_exception(error);
+    std::rethrow_exception(error);
+  }
+  promise.set_value(r);
+  return r;
+}
@@ -0,0 +1,69 @@
+/** Implementation of the pqxx::snapshot_group class.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include "pqxx/snapshot_group"
+
+
+pqxx::snapshot_group::snapshot_group(connection &c) :
+        m_leader{std::make_unique<leader_type>(c, "snapshot_leader")},
+        m_snapshot{
+          m_leader->query_value<std::string>("SELECT pg_export_snapshot()")}
+{}
+
+
+pqxx::snapshot_group::~snapshot_group() noexcept
+{
+  abort();
+}
+
+
+pqxx::snapshot_group::follower_type &
+pqxx::snapshot_group::join(connection &c)
+{
+  if (not m_open)
+    throw usage_error{
+      "Attempt to join snapshot group after its leader has finished."};
+  // The snapshot must be set before anything else happens in the follower,
+  // so we might as well send it along with the BEGIN.
+  auto follower{std::make_unique<follower_type>(
+    c, "snapshot_follower", begin_policy::lazy)};
+  follower->exec0("SET TRANSACTION SNAPSHOT " + follower->quote(m_snapshot));
+  m_followers.push_back(std::move(follower));
+  return *m_followers.back();
+}
+
+
+void pqxx::snapshot_group::commit()
+{
+  m_open = false;
+  for (auto &f : m_followers) f->commit();
+  m_leader->commit();
+}
+
+
+void pqxx::snapshot_group::abort() noexcept
+{
+  m_open = false;
+  for (auto i{m_followers.rbegin()}; i != m_followers.rend(); ++i)
+  {
+    try
+    {
+      (*i)->abort();
+    }
+    catch (std::exception const &)
+    {}
+  }
+  try
+  {
+    m_leader->abort();
+  }
+  catch (std::exception const &)
+  {}
+}
@@ -16,6 +16,7 @@
 
 #include "pqxx/internal/encodings.hxx"
 #include "pqxx/internal/gates/connection-sql_cursor.hxx"
+#include "pqxx/internal/gates/result-sql_cursor.hxx"
 #include "pqxx/internal/gates/transaction-sql_cursor.hxx"
 
 
@@ -86,7 +87,7 @@ find_query_end(std::string_view query, pqxx::internal::encoding_group enc)
 pqxx::internal::sql_cursor::sql_cursor(
   transaction_base &t, std::string_view query, std::string_view cname,
   cursor_base::access_policy ap, cursor_base::update_policy up,
-  cursor_base::ownership_policy op, bool hold) :
+  cursor_base::ownership_policy op, bool hold, bool binary) :
         cursor_base{t.conn(), cname},
         m_home{t.conn()},
         m_adopted{false},
@@ -107,6 +108,9 @@ pqxx::internal::sql_cursor::sql_cursor(
 
   cq << "DECLARE " << t.quote_name(name()) << " ";
 
+  if (binary)
+    cq << "BINARY ";
+
   if (ap == cursor_base::forward_only)
     cq << "NO ";
   cq << "SCROLL ";
@@ -258,6 +262,49 @@ pqxx::result pqxx::internal::sql_cursor::fetch(
 }
 
 
+void pqxx::internal::sql_cursor::start_fetch(difference_type rows)
+{
+  if (m_pending_fetch != 0)
+    throw usage_error{"Started a FETCH on cursor " + name() +
+                      " while another was still pending."};
+  if (rows == 0)
+    throw internal_error{"Asynchronous FETCH of zero rows."};
+  auto const query{"FETCH " + stridestring(rows) + " IN " +
+                   m_home.quote_name(name())};
+  gate::connection_sql_cursor{m_home}.start_exec(query.c_str());
+  m_pending_fetch = rows;
+}
+
+
+pqxx::result
+pqxx::internal::sql_cursor::finish_fetch(difference_type &displacement)
+{
+  if (m_pending_fetch == 0)
+    throw internal_error{"No FETCH pending on cursor " + name() + "."};
+  auto const rows{m_pending_fetch};
+  m_pending_fetch = 0;
+
+  gate::connection_sql_cursor gate{m_home};
+  auto const pgr{gate.get_result()};
+  // The result is followed by a null, which frees up the connection.
+  for (auto extra{gate.get_result()}; extra != nullptr;
+       extra = gate.get_result())
+    internal::clear_result(extra);
+
+  static auto const query{std::make_shared<std::string>("[FETCH]")};
+  auto const r{gate.make_result(pgr, query)};
+  displacement = adjust(rows, difference_type(r.size()));
+  return r;
+}
+
+
+pqxx::result pqxx::internal::sql_cursor::copy_rows(
+  result const &r, result::size_type begin, result::size_type end)
+{
+  return gate::result_sql_cursor{r}.copy_rows(begin, end);
+}
+
+
 pqxx::cursor_base::difference_type pqxx::internal::sql_cursor::move(
   difference_type rows, difference_type &displacement)
 {
@@ -17,12 +17,18 @@
 
 
 pqxx::subtransaction::subtransaction(
-  dbtransaction &t, std::string const &Name) :
+  dbtransaction &t, std::string const &Name, begin_policy policy) :
         namedclass{"subtransaction", t.conn().adorn_name(Name)},
         transactionfocus{t},
-        dbtransaction(t.conn())
+        dbtransaction(t.conn()),
+        m_quoted_name{quote_name(name())},
+        m_savepoint{"SAVEPOINT " + m_quoted_name},
+        m_depth{nesting_depth(t)}
 {
-  direct_exec("SAVEPOINT " + quoted_name());
+  if (policy == begin_policy::lazy)
+    defer(m_savepoint);
+  else
+    direct_exec(m_savepoint);
 }
 
 
@@ -33,18 +39,39 @@ using dbtransaction_ref = pqxx::dbtransaction &;
 
 
 pqxx::subtransaction::subtransaction(
-  subtransaction &t, std::string const &name) :
-        subtransaction(dbtransaction_ref(t), name)
+  subtransaction &t, std::string const &name, begin_policy policy) :
+        subtransaction(dbtransaction_ref(t), name, policy)
 {}
 
 
+std::size_t
+pqxx::subtransaction::nesting_depth(dbtransaction const &parent) noexcept
+{
+  auto const sub{dynamic_cast<subtransaction const *>(&parent)};
+  return (sub == nullptr) ? 1 : (sub->m_depth + 1);
+}
+
+
 void pqxx::subtransaction::do_commit()
 {
-  direct_exec("RELEASE SAVEPOINT " + quoted_name());
+  // If we never set the savepoint, there's nothing to release.
+  if (cancel_deferred(m_savepoint))
+    return;
+  // Releasing our savepoint also releases any nested ones.
+  drop_deferred_releases(m_depth);
+  // Send the RELEASE along with the next statement.  If the enclosing
+  // transaction commits or aborts first, it need not go out at all.
+  defer_release(
+    std::make_shared<std::string>("RELEASE SAVEPOINT " + m_quoted_name),
+    m_depth);
 }
 
 
 void pqxx::subtransaction::do_abort()
 {
-  direct_exec("ROLLBACK TO SAVEPOINT " + quoted_name());
+  // Drop our queued statements, and those of nested subtransactions.  If we
+  // never set the savepoint, there's nothing to roll back.
+  if (discard_deferred(m_savepoint))
+    return;
+  direct_exec("ROLLBACK TO SAVEPOINT " + m_quoted_name);
 }
@@ -16,23 +16,45 @@
 #include "pqxx/result"
 #include "pqxx/transaction"
 
+#include "pqxx/internal/gates/result-transaction.hxx"
+
 
 pqxx::internal::basic_transaction::basic_transaction(
-  connection &c, char const begin_command[]) :
+  connection &c, char const begin_command[], begin_policy policy) :
         namedclass{"transaction"},
-        dbtransaction(c)
+        dbtransaction(c),
+        m_begin_command{begin_command}
 {
   register_transaction();
-  direct_exec(begin_command);
+  if (policy == begin_policy::lazy)
+    defer(begin_command);
+  else
+    direct_exec(begin_command);
 }
 
 
 void pqxx::internal::basic_transaction::do_commit()
 {
   static auto const commit{std::make_shared<std::string>("COMMIT")};
+  // The commit releases all savepoints, so no need to do that separately.
+  auto const dropped_releases{drop_deferred_releases(0)};
+  // If we never started the transaction, there's nothing to commit.
+  if (cancel_deferred(m_begin_command))
+    return;
   try
   {
-    direct_exec(commit);
+    auto const r{direct_exec_single(commit)};
+    std::string_view const status{
+      pqxx::internal::gate::result_transaction{r}.cmd_status()};
+    // In a failed transaction, a RELEASE would have given us an error.  A
+    // COMMIT just quietly rolls back.  Don't let skipping the RELEASE hide
+    // the failure.
+    if (dropped_releases and status == "ROLLBACK")
+      throw sql_error{
+        "Transaction '" + name() +
+          "' had failed on the server, so it was rolled back instead of "
+          "committed.",
+        *commit, "25P02"};
   }
   catch (statement_completion_unknown const &e)
   {
@@ -78,5 +100,8 @@ void pqxx::internal::basic_transaction::do_commit()
 void pqxx::internal::basic_transaction::do_abort()
 {
   static auto const rollback{std::make_shared<std::string>("ROLLBACK")};
-  direct_exec(rollback);
+  // Nothing that's still queued should go out.  If even the BEGIN is still
+  // queued, there's nothing to roll back.
+  if (not discard_deferred(m_begin_command))
+    direct_exec(rollback);
 }
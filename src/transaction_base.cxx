@@ -15,6 +15,7 @@
 #include <stdexcept>
 
 #include "pqxx/connection"
+#include "pqxx/dbtransaction"
 #include "pqxx/result"
 #include "pqxx/transaction_base"
 
@@ -122,6 +123,9 @@ void pqxx::transaction_base::commit()
   try
   {
     do_commit();
+    // If do_commit() didn't talk to the server, as with a nontransaction,
+    // there may still be write-behind statements waiting to go out.
+    pqxx::internal::gate::connection_transaction{conn()}.flush_write_behind();
     m_status = status::committed;
   }
   catch (in_doubt_error const &)
@@ -131,6 +135,21 @@ void pqxx::transaction_base::commit()
   }
   catch (std::exception const &)
   {
+    // If a write-behind statement failed, the COMMIT never executed, and the
+    // server is still in the failed transaction.  Roll it back, or the next
+    // transaction on this connection will fail as well.
+    if (pqxx::internal::gate::connection_transaction{conn()}
+          .in_failed_transaction())
+    {
+      try
+      {
+        do_abort();
+      }
+      catch (std::exception const &e)
+      {
+        m_conn.process_notice(e.what());
+      }
+    }
     m_status = status::aborted;
     throw;
   }
@@ -196,6 +215,14 @@ std::string pqxx::transaction_base::quote_raw(std::string const &bin) const
 
 pqxx::result
 pqxx::transaction_base::exec(std::string_view query, std::string const &desc)
+{
+  check_exec(desc);
+  // TODO: Pass desc to direct_exec(), and from there on down.
+  return direct_exec(query);
+}
+
+
+void pqxx::transaction_base::check_exec(std::string const &desc)
 {
   check_pending_error();
 
@@ -226,9 +253,26 @@ pqxx::transaction_base::exec(std::string_view query, std::string const &desc)
 
   default: throw internal_error{"pqxx::transaction: invalid status code."};
   }
+}
 
-  // TODO: Pass desc to direct_exec(), and from there on down.
-  return direct_exec(query);
+
+void pqxx::transaction_base::set_write_behind(bool on)
+{
+  if (on and dynamic_cast<dbtransaction const *>(this) == nullptr)
+    throw usage_error{
+      "Write-behind mode needs a real transaction, which " + description() +
+      " is not."};
+  m_write_behind = on;
+}
+
+
+pqxx::result pqxx::transaction_base::queue_write_behind(
+  std::string const &query, internal::params &&args, bool prepared)
+{
+  check_exec("");
+  pqxx::internal::gate::connection_transaction{conn()}.write_behind(
+    std::make_shared<std::string>(query), std::move(args), prepared);
+  return result{};
 }
 
 
@@ -389,6 +433,52 @@ pqxx::transaction_base::direct_exec(std::shared_ptr<std::string> c)
 }
 
 
+void pqxx::transaction_base::defer(std::string command)
+{
+  pqxx::internal::gate::connection_transaction{conn()}.defer(
+    std::move(command));
+}
+
+
+pqxx::result
+pqxx::transaction_base::direct_exec_single(std::shared_ptr<std::string> c)
+{
+  check_pending_error();
+  return pqxx::internal::gate::connection_transaction{conn()}.exec_single(c);
+}
+
+
+bool pqxx::transaction_base::cancel_deferred(
+  std::string_view command) noexcept
+{
+  return pqxx::internal::gate::connection_transaction{conn()}.cancel_deferred(
+    command);
+}
+
+
+bool pqxx::transaction_base::discard_deferred(
+  std::string_view command) noexcept
+{
+  return pqxx::internal::gate::connection_transaction{conn()}.discard_deferred(
+    command);
+}
+
+
+void pqxx::transaction_base::defer_release(
+  std::shared_ptr<std::string> c, std::size_t depth)
+{
+  pqxx::internal::gate::connection_transaction{conn()}.defer_release(
+    std::move(c), depth);
+}
+
+
+bool pqxx::transaction_base::drop_deferred_releases(std::size_t depth) noexcept
+{
+  return pqxx::internal::gate::connection_transaction{conn()}
+    .drop_deferred_releases(depth);
+}
+
+
 void pqxx::transaction_base::register_pending_error(
   std::string const &err) noexcept
 {
@@ -0,0 +1,70 @@
+/** Implementation of the transactor framework's retry policy.
+ *
+ * Copyright (c) 2000-2020, Jeroen T. Vermeulen.
+ *
+ * See COPYING for copyright license.  If you did not receive a file called
+ * COPYING with this source code, please notify the distributor of this
+ * mistake, or contact the author.
+ */
+#include "pqxx-source.hxx"
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+#include "pqxx/except"
+#include "pqxx/transactor"
+
+
+pqxx::retry_policy::retry_policy(
+  int attempts, std::chrono::milliseconds initial_delay,
+  std::chrono::milliseconds max_delay) :
+        m_attempts{attempts},
+        m_initial_delay{initial_delay},
+        m_max_delay{max_delay}
+{
+  if (attempts <= 0)
+    throw argument_error{
+      "Zero or negative number of attempts passed to retry_policy."};
+  if (initial_delay.count() < 0 or max_delay < initial_delay)
+    throw range_error{"Invalid delays passed to retry_policy."};
+}
+
+
+pqxx::retry_policy::failure_kind
+pqxx::retry_policy::classify(sql_error const &e) noexcept
+{
+  auto const &state{e.sqlstate()};
+  if (state == "40001" or state == "40P01" or state == "55P03")
+    return failure_kind::conflict;
+  // The rest of class 40 is "transaction rollback."
+  if (state.compare(0, 2, "40") == 0 or
+      dynamic_cast<transaction_rollback const *>(&e) != nullptr)
+    return failure_kind::rollback;
+  return failure_kind::fatal;
+}
+
+
+bool pqxx::retry_policy::retry(failure_kind kind, int attempt)
+{
+  if (kind == failure_kind::conflict)
+    ++m_conflicts;
+  if (kind == failure_kind::fatal or attempt >= m_attempts)
+    return false;
+  if (kind == failure_kind::broken_connection and m_reconnect)
+    m_reconnect();
+
+  // Exponential backoff, with jitter: wait somewhere between half the delay
+  // and the full delay.
+  auto delay{m_initial_delay};
+  for (int i{1}; i < attempt and delay < m_max_delay; ++i) delay *= 2;
+  delay = std::min(delay, m_max_delay);
+  if (delay.count() > 0)
+  {
+    thread_local std::minstd_rand rng{std::random_device{}()};
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter{
+      delay.count() / 2, delay.count()};
+    std::this_thread::sleep_for(std::chrono::milliseconds{jitter(rng)});
+  }
+  return true;
+}
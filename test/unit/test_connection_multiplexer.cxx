@@ -0,0 +1,101 @@
+#include <thread>
+#include <vector>
+
+#include <pqxx/connection_multiplexer>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_connection_multiplexer()
+{
+  pqxx::connection conn;
+  conn.prepare("mux_double", "SELECT 2 * $1::integer");
+  pqxx::connection_multiplexer mux{std::move(conn)};
+
+  PQXX_CHECK_EQUAL(
+    mux.exec("SELECT 'hello'").get()[0][0].as<std::string>(), "hello",
+    "Plain query went wrong.");
+
+  constexpr int num_threads{16}, per_thread{50};
+  std::vector<std::thread> threads;
+  std::vector<int> errors(num_threads, 0);
+  for (int t{0}; t < num_threads; ++t)
+    threads.emplace_back([&mux, &errors, t] {
+      std::vector<std::future<pqxx::result>> params, prepared;
+      for (int i{0}; i < per_thread; ++i)
+      {
+        params.push_back(mux.exec_params("SELECT $1::integer + 1", i));
+        prepared.push_back(mux.exec_prepared("mux_double", t));
+      }
+      for (int i{0}; i < per_thread; ++i)
+      {
+        if (params[std::size_t(i)].get()[0][0].as<int>() != i + 1)
+          ++errors[std::size_t(t)];
+        if (prepared[std::size_t(i)].get()[0][0].as<int>() != 2 * t)
+          ++errors[std::size_t(t)];
+      }
+    });
+  for (auto &th : threads) th.join();
+  for (auto e : errors) PQXX_CHECK_EQUAL(e, 0, "Wrong multiplexed results.");
+
+  // A failing query fails by itself.
+  auto before{mux.exec("SELECT 1")};
+  auto bad{mux.exec("SELECT 1 / 0")};
+  auto after{mux.exec_params("SELECT $1::integer", 3)};
+  PQXX_CHECK_EQUAL(before.get()[0][0].as<int>(), 1, "Query before failed.");
+  PQXX_CHECK_THROWS(bad.get(), pqxx::sql_error, "Bad query did not fail.");
+  PQXX_CHECK_EQUAL(
+    after.get()[0][0].as<int>(), 3, "Failure spilled over to later query.");
+
+  // Nor does it roll back an earlier query in its batch.
+  mux.exec("CREATE TEMP TABLE mux_write (x integer)").get();
+  auto write{mux.exec("INSERT INTO mux_write VALUES (1)")};
+  auto fail{mux.exec("SELECT 1 / 0")};
+  write.get();
+  PQXX_CHECK_THROWS(fail.get(), pqxx::sql_error, "Bad query did not fail.");
+  PQXX_CHECK_EQUAL(
+    mux.exec("SELECT count(*) FROM mux_write").get()[0][0].as<int>(), 1,
+    "Failure rolled back an earlier query.");
+
+  PQXX_CHECK_LESS(
+    mux.batches(), std::size_t(num_threads * per_thread),
+    "Queries were not batched.");
+}
+
+
+void test_connection_multiplexer_reconnect()
+{
+  pqxx::connection_multiplexer mux{pqxx::connection{}};
+  mux.prepare("mux_triple", "SELECT 3 * $1::integer");
+  PQXX_CHECK_EQUAL(
+    mux.exec_prepared("mux_triple", 2).get()[0][0].as<int>(), 6,
+    "Prepared statement went wrong.");
+
+  // Break the multiplexer's connection from the outside.
+  auto const pid{
+    mux.exec("SELECT pg_backend_pid()").get()[0][0].as<int>()};
+  pqxx::connection killer;
+  pqxx::nontransaction{killer}.exec_params(
+    "SELECT pg_terminate_backend($1)", pid);
+
+  // The first query after that may find out the hard way.
+  try
+  {
+    mux.exec("SELECT 1").get();
+  }
+  catch (pqxx::failure const &)
+  {}
+
+  PQXX_CHECK_NOT_EQUAL(
+    mux.exec("SELECT pg_backend_pid()").get()[0][0].as<int>(), pid,
+    "Multiplexer did not reconnect.");
+  PQXX_CHECK_EQUAL(
+    mux.exec_prepared("mux_triple", 5).get()[0][0].as<int>(), 15,
+    "Prepared statement lost after reconnect.");
+}
+} // namespace
+
+
+PQXX_REGISTER_TEST(test_connection_multiplexer);
+PQXX_REGISTER_TEST(test_connection_multiplexer_reconnect);
@@ -0,0 +1,148 @@
+#include <future>
+
+#include <pqxx/connection_pool>
+#include <pqxx/nontransaction>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_connection_pool()
+{
+  PQXX_CHECK_THROWS(
+    pqxx::connection_pool("", 0), pqxx::range_error,
+    "Empty connection pool was accepted.");
+
+  pqxx::connection_pool pool{"", 2};
+  PQXX_CHECK_EQUAL(pool.max_size(), 2u, "Wrong pool size.");
+  PQXX_CHECK_EQUAL(pool.in_use(), 0u, "Pool starts out in use.");
+
+  auto a{pool.acquire()};
+  auto b{pool.acquire()};
+  PQXX_CHECK(a and b, "Empty lease.");
+  PQXX_CHECK(a.get() != b.get(), "Same connection leased out twice.");
+  PQXX_CHECK_EQUAL(pool.in_use(), 2u, "Wrong in_use().");
+  PQXX_CHECK_EQUAL(
+    pqxx::nontransaction{*a}.query_value<int>("SELECT 1"), 1,
+    "Leased connection does not work.");
+
+  // A full pool makes us wait until a connection comes back.
+  auto waiter{std::async(std::launch::async, [&pool] {
+    auto l{pool.acquire()};
+    return l.get();
+  })};
+  PQXX_CHECK(
+    waiter.wait_for(std::chrono::milliseconds{100}) ==
+      std::future_status::timeout,
+    "Acquired a connection from a full pool.");
+  auto const first{a.get()};
+  a.release();
+  PQXX_CHECK(not a, "Released lease still holds a connection.");
+  PQXX_CHECK(waiter.get() == first, "Waiter got the wrong connection.");
+  PQXX_CHECK_EQUAL(pool.idle(), 1u, "Connection did not come back.");
+
+  // A broken connection does not go back into the pool.
+  b->close();
+  b.release();
+  PQXX_CHECK_EQUAL(pool.idle(), 1u, "Closed connection went back to pool.");
+  PQXX_CHECK_EQUAL(pool.in_use(), 0u, "Pool still thinks it's in use.");
+
+  auto c{pool.acquire()};
+  PQXX_CHECK(c.get() == first, "Pool did not reuse idle connection.");
+}
+
+
+void test_connection_pool_priorities()
+{
+  using priority = pqxx::connection_pool::priority;
+  using namespace std::chrono_literals;
+  pqxx::connection_pool pool{"", 1};
+
+  // A queue limit does not stop a request that need not wait.
+  pool.set_max_queued(priority::batch, 0);
+  pool.acquire(priority::batch).release();
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::batch).rejected, 0u,
+    "Rejected a request while a connection was free.");
+  pool.set_max_queued(priority::batch, 1);
+
+  auto held{pool.acquire()};
+
+  // A full pool makes a request with a timeout fail, in time.
+  pool.set_queue_timeout(priority::batch, 50ms);
+  PQXX_CHECK_THROWS(
+    pqxx::ignore_unused(pool.acquire(priority::batch)), pqxx::pool_exhausted,
+    "Queue timeout did not work.");
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::batch).timeouts, 1u, "Timeout not counted.");
+  pool.set_queue_timeout(priority::batch, 0ms);
+
+  // Higher priorities jump the queue.
+  auto batch{std::async(std::launch::async, [&pool] {
+    return pool.acquire(priority::batch);
+  })};
+  PQXX_CHECK(
+    batch.wait_for(50ms) == std::future_status::timeout,
+    "Batch request did not wait.");
+  auto interactive{std::async(std::launch::async, [&pool] {
+    return pool.acquire(priority::interactive);
+  })};
+  PQXX_CHECK(
+    interactive.wait_for(50ms) == std::future_status::timeout,
+    "Interactive request did not wait.");
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::batch).queued, 1u, "Wrong queue depth.");
+
+  // A full queue fails right away.
+  pool.set_max_queued(priority::batch, 1);
+  PQXX_CHECK_THROWS(
+    pqxx::ignore_unused(pool.acquire(priority::batch)), pqxx::pool_exhausted,
+    "Full queue did not reject request.");
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::batch).rejected, 1u, "Rejection not counted.");
+
+  held.release();
+  auto i{interactive.get()};
+  PQXX_CHECK(
+    batch.wait_for(50ms) == std::future_status::timeout,
+    "Batch request went before interactive one.");
+  i.release();
+  auto b{batch.get()};
+  PQXX_CHECK(bool(b), "Batch request never got its connection.");
+
+  auto const stats{pool.stats(priority::interactive)};
+  PQXX_CHECK_EQUAL(stats.acquired, 1u, "Wrong acquisition count.");
+  PQXX_CHECK(
+    stats.max_wait > std::chrono::steady_clock::duration{},
+    "Wait time not measured.");
+}
+
+
+void test_connection_pool_moved_lease()
+{
+  using priority = pqxx::connection_pool::priority;
+  pqxx::connection_pool pool{"", 2};
+  auto interactive{pool.acquire(priority::interactive)};
+  auto batch{pool.acquire(priority::batch)};
+
+  // A lease keeps its priority class when it is move-assigned.
+  batch = std::move(interactive);
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::batch).in_use, 0u,
+    "Overwritten lease did not go back to its class.");
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::interactive).in_use, 1u,
+    "Moved lease lost its class.");
+  batch.release();
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::interactive).in_use, 0u,
+    "Moved lease went back to the wrong class.");
+  PQXX_CHECK_EQUAL(
+    pool.stats(priority::batch).in_use, 0u, "Class use count underflowed.");
+}
+} // namespace
+
+
+PQXX_REGISTER_TEST(test_connection_pool);
+PQXX_REGISTER_TEST(test_connection_pool_priorities);
+PQXX_REGISTER_TEST(test_connection_pool_moved_lease);
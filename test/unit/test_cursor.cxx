@@ -36,13 +36,117 @@ void test_stateless_cursor_ignores_trailing_semicolon(
 }
 
 
+void test_icursorstream_adapts_stride(pqxx::connection_base &conn)
+{
+  pqxx::work tx{conn};
+  pqxx::icursorstream stream{tx, "SELECT * FROM generate_series(1, 1000)",
+                             "adaptive"};
+  stream.set_stride(pqxx::adaptive_stride{});
+  PQXX_CHECK_EQUAL(stream.stride(), 1, "Wrong initial adaptive stride.");
+
+  int expected{1};
+  pqxx::result r;
+  while (stream >> r)
+    for (auto const &row : r)
+      PQXX_CHECK_EQUAL(
+        row[0].as<int>(), expected++, "Adaptive stream lost row.");
+  PQXX_CHECK_EQUAL(expected, 1001, "Wrong number of rows.");
+  PQXX_CHECK_LESS(1, stream.stride(), "Stride never grew.");
+
+  stream.set_stride(3);
+  PQXX_CHECK_EQUAL(stream.stride(), 3, "Fixed stride did not stick.");
+}
+
+
+void test_icursorstream_prefetches(pqxx::connection_base &conn)
+{
+  pqxx::work tx{conn};
+  pqxx::icursorstream stream{tx, "SELECT * FROM generate_series(1, 100)",
+                             "prefetch", 10};
+  stream.set_prefetch();
+  PQXX_CHECK(stream.prefetching(), "Prefetch mode did not stick.");
+
+  pqxx::result r;
+  stream >> r;
+  PQXX_CHECK_EQUAL(r.size(), 10, "Wrong block size.");
+  PQXX_CHECK_EQUAL(r[0][0].as<int>(), 1, "Wrong first row.");
+
+  // While a prefetch is in flight, the transaction is busy.
+  PQXX_CHECK_THROWS(
+    tx.exec("SELECT 1"), pqxx::usage_error,
+    "Could execute query during prefetch.");
+
+  // Skipping rows eats into the prefetched block first.
+  stream.ignore(5);
+  stream >> r;
+  PQXX_CHECK_EQUAL(r.size(), 5, "Wrong size for remainder of block.");
+  PQXX_CHECK_EQUAL(r[0][0].as<int>(), 16, "Wrong row after ignore().");
+  stream.ignore(12);
+  stream >> r;
+  PQXX_CHECK_EQUAL(r[0][0].as<int>(), 33, "Wrong row after long ignore().");
+
+  int expected{r[0][0].as<int>() + int(r.size())};
+  while (stream >> r)
+    for (auto const &row : r)
+      PQXX_CHECK_EQUAL(
+        row[0].as<int>(), expected++, "Prefetching stream lost row.");
+  PQXX_CHECK_EQUAL(expected, 101, "Wrong number of rows.");
+
+  // At the end, the transaction is free again.
+  PQXX_CHECK_EQUAL(
+    tx.query_value<int>("SELECT 2"), 2, "Transaction still busy at end.");
+}
+
+
+void test_adaptive_stride()
+{
+  using namespace std::chrono_literals;
+  PQXX_CHECK_THROWS(
+    pqxx::adaptive_stride(1024, 100ms, 0), pqxx::argument_error,
+    "Zero minimum stride was accepted.");
+  PQXX_CHECK_THROWS(
+    pqxx::adaptive_stride(1024, 100ms, 10, 5), pqxx::argument_error,
+    "Maximum stride below minimum was accepted.");
+
+  // Fast fetches of narrow rows: grow by doubling, up to the maximum.
+  pqxx::adaptive_stride fast{1024 * 1024, 100ms, 1, 50};
+  PQXX_CHECK_EQUAL(fast.stride(), 1, "Did not start at minimum stride.");
+  fast.observe(1, 10, 10, 1ms);
+  PQXX_CHECK_EQUAL(fast.stride(), 2, "Stride did not double.");
+  fast.observe(2, 20, 10, 1ms);
+  PQXX_CHECK_EQUAL(fast.stride(), 4, "Stride did not double again.");
+  for (int i{0}; i < 10; ++i) fast.observe(fast.stride(), 10, 10, 1ms);
+  PQXX_CHECK_EQUAL(fast.stride(), 50, "Stride exceeded maximum.");
+
+  // Slow fetches shrink the stride to meet the latency target.
+  fast.observe(50, 500, 10, 500ms);
+  PQXX_CHECK_EQUAL(fast.stride(), 10, "Stride did not follow latency.");
+
+  // Wide rows: stay within the byte budget.
+  pqxx::adaptive_stride budget{1000, 1s, 1, 1000};
+  for (int i{0}; i < 20; ++i)
+    budget.observe(
+      budget.stride(), std::size_t(budget.stride()) * 100, 100, 1ms);
+  PQXX_CHECK_EQUAL(budget.stride(), 10, "Byte budget not respected.");
+  PQXX_CHECK_EQUAL(budget.row_width(), 100.0, "Wrong row width.");
+
+  // The memory cap goes by the widest row, and overrides the minimum.
+  pqxx::adaptive_stride capped{1024 * 1024, 1s, 20, 1000, 10000};
+  capped.observe(20, 20 * 100, 2000, 1ms);
+  PQXX_CHECK_EQUAL(capped.stride(), 5, "Memory cap not respected.");
+}
+
+
 void test_cursor()
 {
   pqxx::connection conn;
   test_stateless_cursor_provides_random_access(conn);
   test_stateless_cursor_ignores_trailing_semicolon(conn);
+  test_icursorstream_adapts_stride(conn);
+  test_icursorstream_prefetches(conn);
 }
 
 
 PQXX_REGISTER_TEST(test_cursor);
+PQXX_REGISTER_TEST(test_adaptive_stride);
 } // namespace
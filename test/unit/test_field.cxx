@@ -45,5 +45,30 @@ void test_field()
 }
 
 
+
+void test_binary_decoding()
+{
+  using pqxx::internal::decode_binary_int;
+  PQXX_CHECK_EQUAL(
+    decode_binary_int("\x01\x02", 2), 0x0102, "Wrong int2 decoding.");
+  PQXX_CHECK_EQUAL(
+    decode_binary_int("\xff\xff\xff\xfe", 4), -2, "Wrong negative int4.");
+  PQXX_CHECK_EQUAL(
+    decode_binary_int("\x00\x00\x00\x01\x00\x00\x00\x00", 8),
+    0x100000000LL, "Wrong int8 decoding.");
+  PQXX_CHECK_THROWS(
+    decode_binary_int("\x01\x02\x03", 3), pqxx::conversion_error,
+    "Odd-sized binary integer was accepted.");
+
+  using pqxx::internal::decode_binary_float;
+  PQXX_CHECK_EQUAL(
+    decode_binary_float("\x3f\xc0\x00\x00", 4), 1.5, "Wrong float4.");
+  PQXX_CHECK_EQUAL(
+    decode_binary_float("\xc0\x04\x00\x00\x00\x00\x00\x00", 8), -2.5,
+    "Wrong float8.");
+}
+
+
 PQXX_REGISTER_TEST(test_field);
+PQXX_REGISTER_TEST(test_binary_decoding);
 } // namespace
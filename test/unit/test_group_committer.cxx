@@ -0,0 +1,92 @@
+#include <thread>
+#include <vector>
+
+#include <pqxx/group_committer>
+#include <pqxx/transaction>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_group_committer()
+{
+  pqxx::connection conn, check_conn;
+  {
+    pqxx::work tx{check_conn};
+    tx.exec0("DROP TABLE IF EXISTS pqxx_group_commit");
+    tx.exec0("CREATE TABLE pqxx_group_commit (x integer PRIMARY KEY)");
+    tx.commit();
+  }
+
+  PQXX_CHECK_THROWS(
+    pqxx::group_committer(conn, std::chrono::milliseconds{1}, 0),
+    pqxx::range_error, "Zero batch size was accepted.");
+
+  constexpr int num_threads{8}, per_thread{25};
+  std::vector<std::future<void>> dup;
+  {
+    pqxx::group_committer committer{conn, std::chrono::milliseconds{5}, 50};
+    std::vector<std::thread> threads;
+    for (int t{0}; t < num_threads; ++t)
+      threads.emplace_back([&committer, t] {
+        for (int i{0}; i < per_thread; ++i)
+          committer.run([t, i](pqxx::transaction_base &tx) {
+            tx.exec_params0(
+              "INSERT INTO pqxx_group_commit VALUES ($1)", t * per_thread + i);
+          });
+      });
+    for (auto &th : threads) th.join();
+
+    // A failing piece of work only fails by itself.
+    dup.push_back(committer.submit([](pqxx::transaction_base &tx) {
+      tx.exec0("INSERT INTO pqxx_group_commit VALUES (0)");
+    }));
+    dup.push_back(committer.submit([](pqxx::transaction_base &tx) {
+      tx.exec0("INSERT INTO pqxx_group_commit VALUES (-1)");
+    }));
+
+    PQXX_CHECK_THROWS(
+      dup[0].get(), pqxx::unique_violation, "Duplicate insert succeeded.");
+    dup[1].get();
+    auto const committed{committer.committed()};
+
+    // Work that swallows an SQL error fails by itself, even when other work
+    // follows it in the same batch.
+    auto const batches{committer.batches()};
+    auto swallow{committer.submit([](pqxx::transaction_base &tx) {
+      try
+      {
+        tx.exec0("INSERT INTO pqxx_group_commit VALUES (0)");
+      }
+      catch (pqxx::sql_error const &)
+      {}
+    })};
+    auto innocent{committer.submit([](pqxx::transaction_base &tx) {
+      tx.exec0("INSERT INTO pqxx_group_commit VALUES (-2)");
+    })};
+    PQXX_CHECK_THROWS(
+      swallow.get(), pqxx::sql_error, "Swallowed SQL error looked committed.");
+    innocent.get();
+    PQXX_CHECK_EQUAL(
+      committer.batches(), batches + 1, "Tasks did not share a batch.");
+    PQXX_CHECK_EQUAL(
+      committer.committed(), committed + 1, "Wrong count after failed task.");
+
+    PQXX_CHECK_EQUAL(
+      committer.committed(), std::size_t(num_threads * per_thread + 2),
+      "Wrong number of committed tasks.");
+    PQXX_CHECK_LESS(
+      committer.batches(), committer.committed(), "No batching happened.");
+  }
+
+  pqxx::work tx{check_conn};
+  PQXX_CHECK_EQUAL(
+    tx.query_value<int>("SELECT count(*) FROM pqxx_group_commit"),
+    num_threads * per_thread + 2, "Wrong number of rows committed.");
+  tx.exec0("DROP TABLE pqxx_group_commit");
+  tx.commit();
+}
+} // namespace
+
+
+PQXX_REGISTER_TEST(test_group_committer);
@@ -0,0 +1,60 @@
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_keyset_iterator()
+{
+  pqxx::connection conn;
+  {
+    pqxx::work tx{conn};
+    tx.exec0(
+      "CREATE TEMP TABLE pqxx_keyset_test (a integer, b integer, v text)");
+    tx.exec0(
+      "INSERT INTO pqxx_keyset_test "
+      "SELECT i / 10, i % 10, 'v' || i FROM generate_series(0, 99) AS i");
+    tx.commit();
+  }
+
+  PQXX_CHECK_THROWS(
+    pqxx::keyset_iterator(conn, "SELECT * FROM pqxx_keyset_test", {}),
+    pqxx::argument_error, "Keyset without key columns was accepted.");
+
+  pqxx::keyset_iterator keys{
+    conn, "SELECT * FROM pqxx_keyset_test;", {"a", "b"}, 30};
+  PQXX_CHECK_EQUAL(keys.stride(), 30, "Wrong stride.");
+
+  int expected{0}, blocks{0};
+  pqxx::result r;
+  while (keys >> r)
+  {
+    ++blocks;
+    for (auto const &row : r)
+    {
+      PQXX_CHECK_EQUAL(
+        row["v"].as<std::string>(), "v" + pqxx::to_string(expected),
+        "Keyset iterator returned wrong row.");
+      ++expected;
+    }
+    // Each block runs in its own transaction, so the connection is free.
+    PQXX_CHECK_EQUAL(
+      pqxx::nontransaction{conn}.query_value<int>("SELECT 1"), 1,
+      "Connection not usable between keyset blocks.");
+  }
+  PQXX_CHECK_EQUAL(expected, 100, "Keyset iterator missed rows.");
+  PQXX_CHECK_EQUAL(blocks, 4, "Unexpected number of blocks.");
+  PQXX_CHECK(r.empty(), "Final block was not empty.");
+  PQXX_CHECK_EQUAL(keys.last_key().size(), 2u, "Wrong last key size.");
+  PQXX_CHECK_EQUAL(keys.last_key()[0], "9", "Wrong last key.");
+
+  // Resume from a saved key.
+  keys.resume_after({"5", "7"});
+  keys.set_stride(5);
+  keys >> r;
+  PQXX_CHECK_EQUAL(r.size(), 5, "Wrong block size after resume.");
+  PQXX_CHECK_EQUAL(
+    r[0]["v"].as<std::string>(), "v58", "Resumed at the wrong row.");
+}
+
+
+PQXX_REGISTER_TEST(test_keyset_iterator);
+} // namespace
@@ -1,4 +1,7 @@
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 
 #include "../test_helpers.hxx"
@@ -50,5 +53,139 @@ void test_stream_large_object()
 }
 
 
+void test_large_object_file_chunks()
+{
+  std::string contents;
+  for (int i{0}; i < 1000; ++i) contents += pqxx::to_string(i) + '\0';
+  char const in_file[]{"pqxxlo_chunks_in.bin"},
+    out_file[]{"pqxxlo_chunks_out.bin"};
+  std::ofstream{in_file, std::ios::binary} << contents;
+
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+  PQXX_CHECK_THROWS(
+    pqxx::ignore_unused(pqxx::largeobject::import_file(tx, in_file, 0)),
+    pqxx::argument_error,
+    "Zero chunk size was accepted.");
+
+  std::vector<pqxx::largeobject::size_type> steps;
+  auto const track{[&steps](
+                     pqxx::largeobject::size_type done,
+                     pqxx::largeobject::size_type total) {
+    PQXX_CHECK_LESS_EQUAL(done, total, "Progress went past total.");
+    steps.push_back(done);
+  }};
+
+  auto const obj{pqxx::largeobject::import_file(tx, in_file, 1000, track)};
+  std::remove(in_file);
+  PQXX_CHECK_EQUAL(
+    steps.size(), (contents.size() + 999) / 1000,
+    "Wrong number of progress reports on import.");
+  PQXX_CHECK_EQUAL(
+    std::size_t(steps.back()), contents.size(), "Import was incomplete.");
+
+  steps.clear();
+  obj.export_file(tx, out_file, 777, track);
+  PQXX_CHECK_EQUAL(
+    steps.size(), (contents.size() + 776) / 777,
+    "Wrong number of progress reports on export.");
+  std::ifstream in{out_file, std::ios::binary};
+  std::string const exported{
+    std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+  in.close();
+  std::remove(out_file);
+  PQXX_CHECK_EQUAL(exported, contents, "Chunked file round trip failed.");
+
+  obj.remove(tx);
+}
+
+
+void test_large_object_read_ahead()
+{
+  std::string contents;
+  for (int i{0}; i < 2000; ++i) contents += pqxx::to_string(i) + ' ';
+
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+  pqxx::largeobject const obj{tx};
+  pqxx::olostream{tx, obj} << contents;
+
+  pqxx::ilostream read{tx, obj, 100};
+  PQXX_CHECK_THROWS(
+    read.set_read_ahead(-1), pqxx::range_error,
+    "Negative read-ahead depth was accepted.");
+  read.set_read_ahead(3);
+
+  // Reading ahead keeps the transaction busy.
+  std::string first(250, ' ');
+  read.read(first.data(), std::streamsize(first.size()));
+  PQXX_CHECK_EQUAL(
+    first, contents.substr(0, first.size()), "Read-ahead mangled data.");
+  PQXX_CHECK_THROWS(
+    tx.exec("SELECT 1"), std::logic_error,
+    "Read-ahead did not claim the transaction.");
+
+  // Seeking drops whatever was read ahead.
+  PQXX_CHECK_EQUAL(
+    std::size_t(read.tellg()), first.size(), "Wrong position on read-ahead.");
+  read.seekg(10);
+  std::string const rest{
+    std::istreambuf_iterator<char>{read}, std::istreambuf_iterator<char>{}};
+  PQXX_CHECK_EQUAL(rest, contents.substr(10), "Read-ahead after seek failed.");
+
+  PQXX_CHECK_EQUAL(
+    tx.query_value<int>("SELECT 1"), 1,
+    "Transaction still busy after reading to the end.");
+  obj.remove(tx);
+}
+
+
+void test_parallel_large_object()
+{
+  std::string contents;
+  for (int i{0}; i < 5000; ++i) contents += pqxx::to_string(i % 256) + ',';
+
+  pqxx::connection conn1, conn2, conn3;
+  pqxx::largeobject obj;
+  {
+    pqxx::work tx{conn1};
+    obj = pqxx::largeobject{tx};
+    tx.commit();
+  }
+
+  std::vector<pqxx::connection *> const conns{&conn1, &conn2, &conn3};
+  PQXX_CHECK_THROWS(
+    pqxx::parallel_largeobject_writer({}, obj), pqxx::argument_error,
+    "Parallel writer accepted zero connections.");
+
+  pqxx::parallel_largeobject_writer{conns, obj, 1000}.write(contents);
+
+  pqxx::parallel_largeobject_reader reader{conns, obj, 999};
+  PQXX_CHECK_EQUAL(
+    std::size_t(reader.size()), contents.size(),
+    "Parallel write produced wrong size.");
+  PQXX_CHECK_EQUAL(reader.read_all(), contents, "Parallel round trip failed.");
+
+  // Overwriting with less data truncates the object.
+  pqxx::parallel_largeobject_writer{conns, obj, 7}.write(
+    contents.size() / 2,
+    [&contents](pqxx::largeobject::size_type offset, char buf[],
+                std::size_t len) {
+      contents.copy(buf, len, std::size_t(offset));
+    });
+  PQXX_CHECK_EQUAL(
+    pqxx::parallel_largeobject_reader(conns, obj).read_all(),
+    contents.substr(0, contents.size() / 2),
+    "Parallel overwrite went wrong.");
+
+  pqxx::work tx{conn1};
+  obj.remove(tx);
+  tx.commit();
+}
+
+
 PQXX_REGISTER_TEST(test_stream_large_object);
+PQXX_REGISTER_TEST(test_large_object_file_chunks);
+PQXX_REGISTER_TEST(test_large_object_read_ahead);
+PQXX_REGISTER_TEST(test_parallel_large_object);
 } // namespace
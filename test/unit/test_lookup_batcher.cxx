@@ -0,0 +1,141 @@
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include "../test_helpers.hxx"
+
+#include "pqxx/internal/lookup_batcher.hxx"
+
+
+namespace
+{
+using batcher = pqxx::internal::lookup_batcher<int>;
+
+
+void test_lookup_batcher_answers()
+{
+  batcher b{[](std::vector<std::string> const &keys) {
+    batcher::answers out;
+    for (auto const &k : keys)
+      if (k == "bad")
+        out[k].error = std::make_exception_ptr(pqxx::conversion_error{k});
+      else if (k != "missing")
+        out[k].value = int(k.size());
+    return out;
+  }};
+  PQXX_CHECK_EQUAL(b.get("four"), 4, "Wrong answer.");
+  PQXX_CHECK_EQUAL(b.get("missing"), 0, "Missing answer was not default.");
+  PQXX_CHECK_THROWS(
+    b.get("bad"), pqxx::conversion_error, "Per-key error did not arrive.");
+  PQXX_CHECK_EQUAL(b.get("again"), 5, "Batcher broke after an error.");
+}
+
+
+void test_lookup_batcher_batches()
+{
+  using namespace std::chrono_literals;
+  std::promise<void> go;
+  auto const gate{go.get_future().share()};
+  std::vector<std::size_t> batches;
+  batcher b{[&gate, &batches](std::vector<std::string> const &keys) {
+    // The first batch holds things up until the others are all waiting.
+    if (std::empty(batches))
+      gate.wait();
+    batches.push_back(std::size(keys));
+    batcher::answers out;
+    for (auto const &k : keys) out[k].value = int(k.size());
+    return out;
+  }};
+
+  auto first{std::async(std::launch::async, [&b] { return b.get("x"); })};
+  std::this_thread::sleep_for(50ms);
+  std::vector<std::future<int>> others;
+  for (std::string k : {"ab", "abc", "abcd"})
+    others.push_back(
+      std::async(std::launch::async, [&b, k] { return b.get(k); }));
+  std::this_thread::sleep_for(100ms);
+  go.set_value();
+
+  PQXX_CHECK_EQUAL(first.get(), 1, "Wrong answer for first key.");
+  for (std::size_t i{0}; i < std::size(others); ++i)
+    PQXX_CHECK_EQUAL(others[i].get(), int(i) + 2, "Wrong batched answer.");
+  PQXX_CHECK_EQUAL(std::size(batches), 2u, "Waiting keys were not batched.");
+  PQXX_CHECK_EQUAL(batches[1], 3u, "Wrong second batch size.");
+}
+
+
+void test_lookup_batcher_recovers_from_failure()
+{
+  using namespace std::chrono_literals;
+  std::promise<void> go;
+  auto const gate{go.get_future().share()};
+  int calls{0};
+  batcher b{[&gate, &calls](std::vector<std::string> const &keys) {
+    if (calls++ == 0)
+    {
+      gate.wait();
+      throw 42;
+    }
+    batcher::answers out;
+    for (auto const &k : keys) out[k].value = 1;
+    return out;
+  }};
+
+  auto failing{std::async(std::launch::async, [&b] { return b.get("a"); })};
+  std::this_thread::sleep_for(50ms);
+  auto waiting{std::async(std::launch::async, [&b] { return b.get("b"); })};
+  std::this_thread::sleep_for(50ms);
+  go.set_value();
+
+  PQXX_CHECK_THROWS(
+    failing.get(), int, "Lookup failure did not reach its batch.");
+  // If the failure left the batcher busy, this would hang.
+  PQXX_CHECK(
+    waiting.wait_for(5s) == std::future_status::ready,
+    "Waiting thread hung after a failed batch.");
+  PQXX_CHECK_EQUAL(waiting.get(), 1, "Wrong answer after failed batch.");
+  PQXX_CHECK_EQUAL(b.get("c"), 1, "Batcher broke after failure.");
+}
+
+
+void test_lookup_batcher_duplicate_keys()
+{
+  using namespace std::chrono_literals;
+  std::promise<void> go;
+  auto const gate{go.get_future().share()};
+  std::vector<std::vector<std::string>> batches;
+  batcher b{[&gate, &batches](std::vector<std::string> const &keys) {
+    if (std::empty(batches))
+      gate.wait();
+    batches.push_back(keys);
+    batcher::answers out;
+    for (auto const &k : keys) out[k].value = int(k.size());
+    return out;
+  }};
+
+  // Two threads wait for the same key while a batch with that key runs.
+  auto first{std::async(std::launch::async, [&b] { return b.get("dup"); })};
+  std::this_thread::sleep_for(50ms);
+  std::vector<std::future<int>> others;
+  for (int i{0}; i < 2; ++i)
+    others.push_back(
+      std::async(std::launch::async, [&b] { return b.get("dup"); }));
+  std::this_thread::sleep_for(100ms);
+  go.set_value();
+
+  PQXX_CHECK_EQUAL(first.get(), 3, "Wrong answer for first caller.");
+  for (auto &f : others)
+    PQXX_CHECK_EQUAL(f.get(), 3, "Wrong answer for duplicate key.");
+  PQXX_CHECK_EQUAL(std::size(batches), 2u, "Wrong number of batches.");
+  PQXX_CHECK_EQUAL(
+    std::size(batches[1]), 1u, "Duplicate key was looked up twice.");
+  PQXX_CHECK_EQUAL(b.get("dup"), 3, "Batcher broke after duplicate keys.");
+}
+
+
+PQXX_REGISTER_TEST(test_lookup_batcher_answers);
+PQXX_REGISTER_TEST(test_lookup_batcher_batches);
+PQXX_REGISTER_TEST(test_lookup_batcher_recovers_from_failure);
+PQXX_REGISTER_TEST(test_lookup_batcher_duplicate_keys);
+} // namespace
@@ -0,0 +1,88 @@
+#include <future>
+
+#include <pqxx/parallel_executor>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_parallel_executor()
+{
+  pqxx::connection_pool pool{"", 3};
+  pqxx::parallel_executor exec{pool, 0, 4};
+
+  constexpr int num_queries{100};
+  for (int i{0}; i < num_queries; ++i)
+  {
+    auto const idx{
+      (i % 2) ? exec.add("SELECT " + pqxx::to_string(i)) :
+                exec.add_params("SELECT $1::integer", i)};
+    PQXX_CHECK_EQUAL(idx, std::size_t(i), "Wrong task index.");
+  }
+  auto const bad{exec.add("SELECT 1 / 0")};
+  auto const slow{exec.add("SELECT pg_sleep(10)")};
+  exec.set_timeout(slow, std::chrono::milliseconds{200});
+  auto const last{exec.add("SELECT 'last'")};
+  PQXX_CHECK_EQUAL(exec.size(), std::size_t(num_queries + 3), "Wrong size.");
+
+  auto const out{exec.run()};
+  PQXX_CHECK_EQUAL(exec.size(), 0u, "Executor not empty after run().");
+  PQXX_CHECK_EQUAL(out.size(), std::size_t(num_queries + 3), "Lost results.");
+  for (int i{0}; i < num_queries; ++i)
+    PQXX_CHECK_EQUAL(
+      out[std::size_t(i)].get()[0][0].as<int>(), i, "Results out of order.");
+
+  PQXX_CHECK(not out[bad].ok(), "Failing query did not fail.");
+  PQXX_CHECK_THROWS(
+    out[bad].get(), pqxx::sql_error, "Failure did not rethrow.");
+
+  PQXX_CHECK(not out[slow].ok(), "Timeout did not work.");
+  try
+  {
+    out[slow].get();
+  }
+  catch (pqxx::sql_error const &e)
+  {
+    PQXX_CHECK_EQUAL(
+      std::string{e.sqlstate()}, "57014", "Wrong error for timeout.");
+  }
+
+  PQXX_CHECK_EQUAL(
+    out[last].get()[0][0].as<std::string>(), "last",
+    "Failures affected other queries.");
+  PQXX_CHECK_EQUAL(pool.in_use(), 0u, "Executor kept connections.");
+
+  // The timeout does not stick to the pool's connections.
+  auto c{pool.acquire()};
+  PQXX_CHECK_EQUAL(
+    pqxx::nontransaction{*c}.query_value<std::string>(
+      "SHOW statement_timeout"),
+    "0", "Statement timeout leaked into pool.");
+}
+
+void test_parallel_executor_with_held_lease()
+{
+  // The caller holds one of the pool's connections.  The worker that
+  // doesn't get a connection must not keep run() waiting.
+  pqxx::connection_pool pool{"", 2};
+  auto held{pool.acquire()};
+  pqxx::parallel_executor exec{pool, 0, 2};
+  constexpr int num_queries{20};
+  for (int i{0}; i < num_queries; ++i)
+    exec.add_params("SELECT $1::integer", i);
+
+  auto run{std::async(std::launch::async, [&exec] { return exec.run(); })};
+  PQXX_CHECK(
+    run.wait_for(std::chrono::seconds{10}) == std::future_status::ready,
+    "Executor waited for a connection that the caller holds.");
+  auto const out{run.get()};
+  for (int i{0}; i < num_queries; ++i)
+    PQXX_CHECK_EQUAL(
+      out[std::size_t(i)].get()[0][0].as<int>(), i, "Wrong result.");
+  PQXX_CHECK_EQUAL(pool.in_use(), 1u, "Executor kept connections.");
+}
+} // namespace
+
+
+PQXX_REGISTER_TEST(test_parallel_executor);
+PQXX_REGISTER_TEST(test_parallel_executor_with_held_lease);
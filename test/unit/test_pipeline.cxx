@@ -1,4 +1,5 @@
 #include <chrono>
+#include <vector>
 
 #include "../test_helpers.hxx"
 
@@ -55,6 +56,237 @@ void test_pipeline()
     std::chrono::duration_cast<std::chrono::seconds>(finish - start).count()};
   PQXX_CHECK_LESS(seconds, 5, "Canceling a sleep took suspiciously long.");
 }
+
+
+void test_pipeline_many_queries()
+{
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+  pqxx::pipeline pipe{tx};
+
+  constexpr int num_queries{1000};
+  pipe.retain(50);
+  std::vector<pqxx::pipeline::query_id> ids;
+  for (int i{0}; i < num_queries; ++i)
+    ids.push_back(pipe.insert("SELECT " + pqxx::to_string(i)));
+
+  // Retrieve every other result out of order, then the rest in order.
+  for (int i{num_queries - 1}; i >= 0; i -= 2)
+  {
+    auto const r{pipe.retrieve(ids[std::size_t(i)])};
+    PQXX_CHECK_EQUAL(r[0][0].as<int>(), i, "Out-of-order result is wrong.");
+    PQXX_CHECK_EQUAL(
+      r.query(), "SELECT " + pqxx::to_string(i),
+      "Result has wrong query text.");
+  }
+  PQXX_CHECK_THROWS(
+    pipe.retrieve(ids[1]), std::logic_error,
+    "Retrieving a result twice did not fail.");
+
+  for (int i{0}; i < num_queries; i += 2)
+  {
+    auto const [id, r]{pipe.retrieve()};
+    PQXX_CHECK_EQUAL(id, ids[std::size_t(i)], "Wrong oldest query.");
+    PQXX_CHECK_EQUAL(r[0][0].as<int>(), i, "In-order result is wrong.");
+  }
+  PQXX_CHECK(pipe.empty(), "Pipeline not empty after retrieving everything.");
+
+  // The pipeline is still usable after running empty.
+  auto const q{pipe.insert("SELECT 'again'")};
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(q)[0][0].as<std::string>(), "again",
+    "Pipeline broke after running empty.");
+}
+
+
+void test_pipeline_params()
+{
+  pqxx::connection conn;
+  conn.prepare("pipeline_double", "SELECT 2 * $1::integer");
+  pqxx::work tx{conn};
+  pqxx::pipeline pipe{tx};
+  pipe.retain(20);
+
+  // Mix plain, parameterised, and prepared queries.
+  auto const plain{pipe.insert("SELECT 'plain'")};
+  auto const p1{pipe.insert_params("SELECT $1::integer + 1", 10)};
+  auto const p2{pipe.insert_params("SELECT $1::text", "it's")};
+  auto const n{pipe.insert_params("SELECT $1::integer IS NULL", nullptr)};
+  auto const pr1{pipe.insert_prepared("pipeline_double", 21)};
+  auto const pr2{pipe.insert_prepared("pipeline_double", 50)};
+  auto const plain2{pipe.insert("SELECT 'plain again'")};
+
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(pr2)[0][0].as<int>(), 100,
+    "Wrong result from prepared statement in pipeline.");
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(plain)[0][0].as<std::string>(), "plain",
+    "Wrong result from plain query.");
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(p1)[0][0].as<int>(), 11,
+    "Wrong result from parameterised query.");
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(p2)[0][0].as<std::string>(), "it's",
+    "String parameter came out wrong.");
+  PQXX_CHECK(
+    pipe.retrieve(n)[0][0].as<bool>(),
+    "Null parameter did not come out null.");
+  auto const r{pipe.retrieve(pr1)};
+  PQXX_CHECK_EQUAL(r[0][0].as<int>(), 42, "Wrong prepared result.");
+  PQXX_CHECK_EQUAL(
+    r.query(), "pipeline_double", "Wrong query text on prepared result.");
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(plain2)[0][0].as<std::string>(), "plain again",
+    "Wrong result from plain query after extended ones.");
+  PQXX_CHECK(pipe.empty(), "Pipeline not empty.");
+
+  // The connection is usable for regular queries afterwards.
+  pipe.complete();
+  PQXX_CHECK_EQUAL(
+    tx.query_value<int>("SELECT 9"), 9, "Connection unusable after pipeline.");
+}
+
+
+void test_pipeline_params_error()
+{
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+  pqxx::pipeline pipe{tx};
+  pipe.retain(10);
+
+  auto const good{pipe.insert_params("SELECT $1::integer", 1)};
+  auto const bad{pipe.insert_params("SELECT $1::integer / 0", 1)};
+  auto const after{pipe.insert_params("SELECT $1::integer", 3)};
+
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(good)[0][0].as<int>(), 1,
+    "Query before failure failed.");
+  PQXX_CHECK_THROWS(
+    pipe.retrieve(bad), pqxx::sql_error, "Failing query did not fail.");
+  PQXX_CHECK_THROWS(
+    pipe.retrieve(after), std::runtime_error,
+    "Query after failure did not report the error.");
+}
+
+
+void test_pipeline_adaptive_retain()
+{
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+  pqxx::pipeline pipe{tx};
+
+  PQXX_CHECK_THROWS(
+    pipe.retain_adaptive(-1, 10), pqxx::range_error,
+    "Negative minimum retention was accepted.");
+  PQXX_CHECK_THROWS(
+    pipe.retain_adaptive(10, 5), pqxx::range_error,
+    "Maximum retention below minimum was accepted.");
+
+  PQXX_CHECK_EQUAL(
+    pipe.last_batch().queries, 0, "Got batch stats before any batch.");
+
+  // A batch of one query says nothing about the time per query, so it must
+  // not make the pipeline hold back queries.
+  pipe.retain_adaptive(1, 50);
+  for (int round{0}; round < 3; ++round)
+  {
+    pipe.retrieve(pipe.insert("SELECT 1"));
+    PQXX_CHECK_EQUAL(
+      pipe.last_batch().queries, 1, "Expected a single-query batch.");
+    PQXX_CHECK_EQUAL(
+      pipe.retain_limit(), 1, "Single-query batch inflated retention.");
+  }
+
+  pipe.retain_adaptive(2, 50);
+  for (int round{0}; round < 10; ++round)
+  {
+    std::vector<pqxx::pipeline::query_id> ids;
+    for (int i{0}; i < 20; ++i)
+      ids.push_back(pipe.insert("SELECT " + pqxx::to_string(i)));
+    for (int i{0}; i < 20; ++i)
+      PQXX_CHECK_EQUAL(
+        pipe.retrieve(ids[std::size_t(i)])[0][0].as<int>(), i,
+        "Wrong result in adaptive mode.");
+  }
+
+  auto const stats{pipe.last_batch()};
+  PQXX_CHECK_LESS(0, stats.queries, "No batch stats.");
+  PQXX_CHECK(
+    stats.first_result <= stats.last_result, "Inconsistent batch timings.");
+  PQXX_CHECK_BOUNDS(
+    pipe.retain_limit(), 2, 51, "Adaptive retention out of bounds.");
+
+  // Setting a fixed retention ends adaptive mode.
+  pipe.retain(7);
+  pipe.retrieve(pipe.insert("SELECT 1"));
+  PQXX_CHECK_EQUAL(pipe.retain_limit(), 7, "Fixed retention did not stick.");
+}
+
+
+void test_pipeline_completion_handlers()
+{
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+  pqxx::pipeline pipe{tx};
+  pipe.retain(5);
+
+  std::vector<std::pair<pqxx::pipeline::query_id, int>> seen;
+  auto const handler{[&seen](
+                       pqxx::pipeline::query_id id, pqxx::result const &r,
+                       std::exception_ptr err) {
+    PQXX_CHECK(not err, "Unexpected error in completion handler.");
+    seen.emplace_back(id, r[0][0].as<int>());
+  }};
+
+  auto const a{pipe.insert("SELECT 1", handler)};
+  auto const b{pipe.insert("SELECT 2")};
+  auto const c{pipe.insert("SELECT 3", handler)};
+  auto f{pipe.insert_future("SELECT 4")};
+  pipe.complete();
+
+  PQXX_CHECK_EQUAL(seen.size(), 2u, "Wrong number of handler calls.");
+  PQXX_CHECK_EQUAL(seen[0].first, a, "Handlers called in wrong order.");
+  PQXX_CHECK_EQUAL(seen[0].second, 1, "Wrong result passed to handler.");
+  PQXX_CHECK_EQUAL(seen[1].first, c, "Wrong query id passed to handler.");
+  PQXX_CHECK_EQUAL(seen[1].second, 3, "Wrong result for second handler.");
+  PQXX_CHECK_EQUAL(f.get()[0][0].as<int>(), 4, "Wrong result from future.");
+
+  // Handled queries are gone from the pipeline; the others remain.
+  PQXX_CHECK_THROWS(
+    pipe.retrieve(a), std::logic_error, "Handled result was still there.");
+  PQXX_CHECK_EQUAL(
+    pipe.retrieve(b)[0][0].as<int>(), 2, "Unhandled result went wrong.");
+  PQXX_CHECK(pipe.empty(), "Pipeline not empty.");
+}
+
+
+void test_pipeline_future_error()
+{
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+  pqxx::pipeline pipe{tx};
+  pipe.retain(5);
+
+  // A flushed query breaks its promise.
+  auto flushed{pipe.insert_future("SELECT 0")};
+  pipe.flush();
+  PQXX_CHECK_THROWS(
+    flushed.get(), std::future_error, "Flushed future did not break.");
+
+  auto bad{pipe.insert_future("SELECT 1/0")};
+  auto after{pipe.insert_future("SELECT 1")};
+  pipe.complete();
+  PQXX_CHECK_THROWS(bad.get(), pqxx::sql_error, "Error did not reach future.");
+  PQXX_CHECK_THROWS(
+    after.get(), std::runtime_error,
+    "Query after error did not report failure.");
+}
 } // namespace
 
 PQXX_REGISTER_TEST(test_pipeline);
+PQXX_REGISTER_TEST(test_pipeline_many_queries);
+PQXX_REGISTER_TEST(test_pipeline_params);
+PQXX_REGISTER_TEST(test_pipeline_params_error);
+PQXX_REGISTER_TEST(test_pipeline_adaptive_retain);
+PQXX_REGISTER_TEST(test_pipeline_completion_handlers);
+PQXX_REGISTER_TEST(test_pipeline_future_error);
@@ -0,0 +1,74 @@
+#include <pqxx/nontransaction>
+#include <pqxx/routing_connection_set>
+#include <pqxx/transaction>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+// A replica we can't connect to.
+char const bad_replica[]{"host=/pqxx-nonexistent-dir port=1"};
+
+
+void test_routing_connection_set()
+{
+  // The "replica" that works is really the primary again.
+  pqxx::routing_connection_set routes{"", {bad_replica, ""}, 2};
+  PQXX_CHECK_EQUAL(routes.replicas(), 2u, "Wrong number of replicas.");
+  PQXX_CHECK(routes.healthy(0), "Replica starts out unhealthy.");
+
+  {
+    auto r{routes.read()};
+    PQXX_CHECK(bool(r), "No connection for reading.");
+    PQXX_CHECK_EQUAL(
+      pqxx::read_transaction{*r}.query_value<int>("SELECT 5"), 5,
+      "Read connection does not work.");
+  }
+  PQXX_CHECK(not routes.healthy(0), "Failed replica still healthy.");
+  PQXX_CHECK(routes.healthy(1), "Working replica became unhealthy.");
+
+  // Read your own writes.
+  std::string lsn;
+  {
+    auto w{routes.write()};
+    pqxx::work tx{*w};
+    tx.exec0("SELECT 1");
+    tx.commit();
+    lsn = pqxx::routing_connection_set::wal_position(*w);
+  }
+  PQXX_CHECK(not lsn.empty(), "No WAL position.");
+  auto const r{routes.read(lsn, std::chrono::milliseconds{500})};
+  PQXX_CHECK(bool(r), "No connection for reading own writes.");
+}
+
+
+void test_routing_connection_set_falls_back_to_primary()
+{
+  pqxx::routing_connection_set routes{"", {bad_replica}, 1};
+  auto const r{routes.read()};
+  PQXX_CHECK(bool(r), "No fallback to primary.");
+  PQXX_CHECK_EQUAL(
+    routes.primary().in_use(), 1u, "Read did not go to the primary.");
+}
+
+
+void test_routing_connection_set_skips_busy_replica()
+{
+  pqxx::routing_connection_set routes{"", {""}, 1};
+  auto const first{routes.read()};
+  PQXX_CHECK_EQUAL(
+    routes.primary().in_use(), 0u, "First read did not go to the replica.");
+
+  // The replica has no connections left.  Don't wait for it.
+  auto const second{routes.read()};
+  PQXX_CHECK(bool(second), "No connection for second read.");
+  PQXX_CHECK_EQUAL(
+    routes.primary().in_use(), 1u, "Busy replica did not fall back.");
+  PQXX_CHECK(routes.healthy(0), "Busy replica was marked down.");
+}
+} // namespace
+
+
+PQXX_REGISTER_TEST(test_routing_connection_set);
+PQXX_REGISTER_TEST(test_routing_connection_set_falls_back_to_primary);
+PQXX_REGISTER_TEST(test_routing_connection_set_skips_busy_replica);
@@ -0,0 +1,127 @@
+#include <vector>
+
+#include <pqxx/shard_router>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_shard_router_functions()
+{
+  PQXX_CHECK_THROWS(
+    pqxx::ignore_unused(pqxx::shard_router::hash_shards(0)),
+    pqxx::argument_error, "Hashing to zero shards was accepted.");
+
+  auto const hash{pqxx::shard_router::hash_shards(16)};
+  std::vector<int> counts(16, 0);
+  for (int i{0}; i < 1600; ++i)
+  {
+    auto const key{pqxx::to_string(i)};
+    auto const n{hash(key)};
+    PQXX_CHECK_LESS(n, 16u, "Hash went out of range.");
+    PQXX_CHECK_EQUAL(hash(key), n, "Hash is not deterministic.");
+    ++counts[n];
+  }
+  for (auto const c : counts)
+    PQXX_CHECK_BOUNDS(c, 50, 150, "Hash spreads keys unevenly.");
+
+  // Growing the number of shards moves only a fraction of the keys.
+  auto const bigger{pqxx::shard_router::hash_shards(17)};
+  int moved{0};
+  for (int i{0}; i < 1600; ++i)
+  {
+    auto const key{pqxx::to_string(i)};
+    if (bigger(key) != hash(key))
+      ++moved;
+  }
+  PQXX_CHECK_LESS(moved, 200, "Too many keys moved when adding a shard.");
+
+  auto const range{pqxx::shard_router::range_shards<int>({100, 200})};
+  PQXX_CHECK_EQUAL(range("-5"), 0u, "Wrong shard for low key.");
+  PQXX_CHECK_EQUAL(range("99"), 0u, "Wrong shard below first bound.");
+  PQXX_CHECK_EQUAL(range("100"), 1u, "Wrong shard at first bound.");
+  PQXX_CHECK_EQUAL(range("199"), 1u, "Wrong shard below second bound.");
+  PQXX_CHECK_EQUAL(range("200"), 2u, "Wrong shard at second bound.");
+  PQXX_CHECK_THROWS(
+    pqxx::ignore_unused(pqxx::shard_router::range_shards<int>({2, 1})),
+    pqxx::argument_error, "Unsorted range bounds were accepted.");
+
+  // Constructing a router does not connect yet.
+  pqxx::shard_router router{
+    {"", ""}, [](std::string_view) -> std::size_t { return 2; }};
+  PQXX_CHECK_EQUAL(router.size(), 2u, "Wrong number of shards.");
+  PQXX_CHECK_THROWS(
+    pqxx::ignore_unused(router.shard_of(1)), pqxx::range_error,
+    "Out-of-range shard function result was accepted.");
+  PQXX_CHECK_THROWS(
+    pqxx::ignore_unused(router.shard(2)), pqxx::range_error,
+    "Out-of-range shard number was accepted.");
+  PQXX_CHECK_THROWS(
+    pqxx::shard_router({}), pqxx::argument_error,
+    "Router without shards was accepted.");
+}
+
+
+void test_shard_router()
+{
+  pqxx::shard_router router{
+    {"", ""}, pqxx::shard_router::range_shards<int>({100}), 2};
+  PQXX_CHECK_EQUAL(router.shard_of(42), 0u, "Wrong shard for key.");
+  PQXX_CHECK_EQUAL(router.shard_of(142), 1u, "Wrong shard for high key.");
+
+  {
+    auto lease{router.acquire(142)};
+    PQXX_CHECK(bool(lease), "Router did not lease a connection.");
+    PQXX_CHECK(
+      &router.shard(1) != &router.shard(0), "Shards share a pool.");
+  }
+
+  auto const all{router.for_each_shard(
+    [](pqxx::transaction_base &tx, std::size_t n) {
+      return tx.exec_params("SELECT $1::integer AS shard", n);
+    })};
+  PQXX_CHECK_EQUAL(all.size(), 2u, "Wrong number of shard results.");
+  PQXX_CHECK_EQUAL(all[1][0][0].as<int>(), 1, "Results out of shard order.");
+
+  auto const merged{router.scatter("SELECT generate_series(1, 3) AS n")};
+  PQXX_CHECK_EQUAL(merged.size(), 6, "Wrong number of merged rows.");
+  PQXX_CHECK_EQUAL(merged[3][0].as<int>(), 1, "Wrong merged row.");
+  PQXX_CHECK_EQUAL(
+    merged.column_name(0), std::string{"n"}, "Merged result lost columns.");
+
+  // Statements prepared through the router reach every shard, including on
+  // connections that were already open.
+  router.prepare("shard_double", "SELECT 2 * $1::integer");
+  auto const prepared{router.scatter_prepared("shard_double", 21)};
+  PQXX_CHECK_EQUAL(prepared.size(), 2, "Wrong prepared scatter size.");
+  PQXX_CHECK_EQUAL(prepared[1][0].as<int>(), 42, "Wrong prepared result.");
+
+  auto const params{router.scatter_params("SELECT $1::text", "x")};
+  PQXX_CHECK_EQUAL(params.size(), 2, "Wrong parameterised scatter size.");
+  auto const urgent{router.scatter_prepared(
+    pqxx::connection_pool::priority::interactive, "shard_double", 1)};
+  PQXX_CHECK_EQUAL(urgent[0][0].as<int>(), 2, "Wrong prioritised result.");
+  PQXX_CHECK_EQUAL(
+    router.shard(0).stats(pqxx::connection_pool::priority::interactive)
+      .acquired,
+    1u, "Scatter ignored its priority.");
+
+  PQXX_CHECK_THROWS(
+    router.scatter("SELECT 1/0"), pqxx::sql_error,
+    "Error on a shard did not come through.");
+
+  std::vector<pqxx::result> const mismatched{
+    all[0], router.scatter("SELECT 'x'::text")};
+  PQXX_CHECK_THROWS(
+    pqxx::shard_router::merge(mismatched), pqxx::argument_error,
+    "Merged results with different column types.");
+  std::vector<pqxx::result> const renamed{
+    all[0], router.scatter("SELECT 0::integer AS other")};
+  PQXX_CHECK_THROWS(
+    pqxx::shard_router::merge(renamed), pqxx::argument_error,
+    "Merged results with different column names.");
+}
+} // namespace
+
+PQXX_REGISTER_TEST(test_shard_router_functions);
+PQXX_REGISTER_TEST(test_shard_router);
@@ -0,0 +1,51 @@
+#include <thread>
+#include <vector>
+
+#include <pqxx/single_flight>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_single_flight()
+{
+  pqxx::connection_pool pool{"", 1};
+  {
+    auto c{pool.acquire()};
+    c->prepare("flight_slow", "SELECT $1::integer FROM pg_sleep(0.5)");
+  }
+  pqxx::single_flight flight{pool};
+
+  constexpr int num_threads{10};
+  std::vector<std::thread> threads;
+  std::vector<int> results(num_threads, 0);
+  for (int t{0}; t < num_threads; ++t)
+    threads.emplace_back([&flight, &results, t] {
+      results[std::size_t(t)] =
+        flight.exec_prepared("flight_slow", 42)[0][0].as<int>();
+    });
+  for (auto &th : threads) th.join();
+
+  for (auto r : results) PQXX_CHECK_EQUAL(r, 42, "Wrong shared result.");
+  PQXX_CHECK_EQUAL(
+    flight.executions() + flight.coalesced(), std::size_t(num_threads),
+    "Lost count of queries.");
+  PQXX_CHECK_LESS(
+    flight.executions(), std::size_t(num_threads), "Nothing got coalesced.");
+
+  // Different parameters mean different queries.
+  PQXX_CHECK_EQUAL(
+    flight.exec_params("SELECT $1::text", "a")[0][0].as<std::string>(), "a",
+    "Wrong result.");
+  PQXX_CHECK_EQUAL(
+    flight.exec_params("SELECT $1::text", nullptr)[0][0].is_null(), true,
+    "Null parameter got lost.");
+
+  // Errors reach the caller.
+  PQXX_CHECK_THROWS(
+    flight.exec("SELECT 1 / 0"), pqxx::sql_error, "Error got lost.");
+}
+} // namespace
+
+
+PQXX_REGISTER_TEST(test_single_flight);
@@ -0,0 +1,55 @@
+#include <pqxx/snapshot_group>
+
+#include "../test_helpers.hxx"
+
+namespace
+{
+void test_snapshot_group()
+{
+  pqxx::connection lead_conn, conn1, conn2;
+  {
+    pqxx::work tx{lead_conn};
+    tx.exec0("DROP TABLE IF EXISTS pqxx_snapshot_group");
+    tx.exec0("CREATE TABLE pqxx_snapshot_group (x integer)");
+    tx.exec0("INSERT INTO pqxx_snapshot_group VALUES (1), (2), (3)");
+    tx.commit();
+  }
+
+  pqxx::snapshot_group group{lead_conn};
+  PQXX_CHECK(not group.snapshot_id().empty(), "No snapshot id.");
+  auto &f1{group.join(conn1)};
+  PQXX_CHECK_EQUAL(group.size(), 1u, "Wrong number of followers.");
+  PQXX_CHECK(&group.follower(0) == &f1, "Wrong follower.");
+
+  // A change committed after the export is invisible to the whole group.
+  {
+    pqxx::connection other;
+    pqxx::work tx{other};
+    tx.exec0("INSERT INTO pqxx_snapshot_group VALUES (4)");
+    tx.commit();
+  }
+  auto &f2{group.join(conn2)};
+  char const query[]{"SELECT count(*) FROM pqxx_snapshot_group"};
+  PQXX_CHECK_EQUAL(
+    group.leader().query_value<int>(query), 3, "Leader saw later change.");
+  PQXX_CHECK_EQUAL(f1.query_value<int>(query), 3, "Follower saw new data.");
+  PQXX_CHECK_EQUAL(
+    f2.query_value<int>(query), 3, "Late follower saw new data.");
+
+  PQXX_CHECK_EQUAL(
+    f1.query_value<std::string>("SHOW transaction_read_only"), "on",
+    "Follower was not read-only.");
+
+  group.commit();
+  PQXX_CHECK_THROWS(
+    group.join(conn1), pqxx::usage_error,
+    "Could join snapshot group after commit.");
+
+  pqxx::work tx{lead_conn};
+  tx.exec0("DROP TABLE pqxx_snapshot_group");
+  tx.commit();
+}
+} // namespace
+
+
+PQXX_REGISTER_TEST(test_snapshot_group);
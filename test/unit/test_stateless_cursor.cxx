@@ -77,5 +77,105 @@ void test_stateless_cursor()
 }
 
 
+void test_stateless_cursor_cache()
+{
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+
+  pqxx::stateless_cursor<
+    pqxx::cursor_base::read_only, pqxx::cursor_base::owned>
+    stateless(tx, "SELECT generate_series(0, 99)", "cached", false);
+  PQXX_CHECK_THROWS(
+    stateless.set_cache(-1, 4), pqxx::range_error,
+    "Negative cache block size was accepted.");
+  stateless.set_cache(10, 3);
+
+  // Sequential pages, smaller than a block.
+  for (int page{0}; page < 20; ++page)
+  {
+    auto const rows{stateless.retrieve(page * 5, page * 5 + 5)};
+    PQXX_CHECK_EQUAL(rows.size(), 5, "Wrong page size from cache.");
+    PQXX_CHECK_EQUAL(rows[0][0].as<int>(), page * 5, "Wrong cached page.");
+    PQXX_CHECK_EQUAL(rows[4][0].as<int>(), page * 5 + 4, "Wrong page end.");
+  }
+
+  // Random, overlapping, and block-crossing ranges still give the same rows.
+  int const ranges[][2]{{93, 97}, {3, 8}, {95, 100}, {8, 14},
+                        {20, 20}, {50, 40}, {99, 200}, {4, 7}};
+  for (auto const &range : ranges)
+  {
+    auto const rows{stateless.retrieve(range[0], range[1])};
+    auto const end{std::min(range[1], 100)};
+    auto const step{(range[0] <= end) ? 1 : -1};
+    PQXX_CHECK_EQUAL(
+      rows.size(), pqxx::result::size_type((end - range[0]) * step),
+      "Wrong row count with cache.");
+    for (pqxx::result::size_type i{0}; i < rows.size(); ++i)
+      PQXX_CHECK_EQUAL(
+        rows[i][0].as<int>(), (range[0] - (step < 0)) + step * i,
+        "Wrong row from cache.");
+  }
+
+  PQXX_CHECK_THROWS(
+    stateless.retrieve(101, 102), pqxx::range_error,
+    "Cache allowed out-of-range retrieval.");
+
+  stateless.set_cache(0, 0);
+  PQXX_CHECK_EQUAL(
+    stateless.retrieve(2, 3)[0][0].as<int>(), 2,
+    "Retrieval broke after disabling cache.");
+}
+
+
+void test_binary_stateless_cursor()
+{
+  pqxx::connection conn;
+  pqxx::work tx{conn};
+
+  pqxx::stateless_cursor<
+    pqxx::cursor_base::read_only, pqxx::cursor_base::owned>
+    cur(
+      tx,
+      "SELECT i::smallint, i, i::bigint * 3000000000, i * 0.5::float8, "
+      "i % 2 = 0, 'row ' || i, NULL::integer "
+      "FROM generate_series(-2, 2) AS i",
+      "binarycur", false, true);
+
+  auto const rows{cur.retrieve(0, 5)};
+  PQXX_CHECK_EQUAL(rows.size(), 5, "Wrong row count from binary cursor.");
+  PQXX_CHECK(rows[0][0].is_binary(), "Binary cursor produced text.");
+  PQXX_CHECK(
+    rows.column_format(1) == pqxx::format::binary, "Wrong column format.");
+  for (int i{-2}; i <= 2; ++i)
+  {
+    auto const row{rows[i + 2]};
+    PQXX_CHECK_EQUAL(row[0].as<short>(), i, "Wrong binary smallint.");
+    PQXX_CHECK_EQUAL(row[1].as<int>(), i, "Wrong binary integer.");
+    PQXX_CHECK_EQUAL(
+      row[2].as<long long>(), i * 3000000000LL, "Wrong binary bigint.");
+    PQXX_CHECK_EQUAL(row[3].as<double>(), i * 0.5, "Wrong binary float8.");
+    PQXX_CHECK_EQUAL(row[4].as<bool>(), i % 2 == 0, "Wrong binary boolean.");
+    PQXX_CHECK_EQUAL(
+      row[5].as<std::string>(), "row " + pqxx::to_string(i),
+      "Wrong binary text.");
+    PQXX_CHECK(not row[6].get<int>(), "Binary null came out non-null.");
+  }
+  PQXX_CHECK_EQUAL(
+    rows[4][1].get<long>().value(), 2L, "Optional from binary is broken.");
+  PQXX_CHECK_THROWS(
+    rows[0][5].as<int>(), pqxx::conversion_error,
+    "Binary text converted to integer.");
+
+  pqxx::stateless_cursor<
+    pqxx::cursor_base::read_only, pqxx::cursor_base::owned>
+    bytes(tx, "SELECT '\\x00ff'::bytea", "binarybytea", false, true);
+  pqxx::binarystring const b{bytes.retrieve(0, 1)[0][0]};
+  PQXX_CHECK_EQUAL(b.size(), 2u, "Wrong binary bytea size.");
+  PQXX_CHECK_EQUAL(int(b[1]), 0xff, "Wrong binary bytea data.");
+}
+
+
 PQXX_REGISTER_TEST(test_stateless_cursor);
+PQXX_REGISTER_TEST(test_stateless_cursor_cache);
+PQXX_REGISTER_TEST(test_binary_stateless_cursor);
 } // namespace
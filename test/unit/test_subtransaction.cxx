@@ -71,5 +71,84 @@ void test_subtransaction()
 }
 
 
+void test_subtransaction_release_is_deferred()
+{
+  pqxx::connection conn;
+  {
+    pqxx::work trans{conn};
+    make_table(trans);
+
+    // Per-row error isolation.  Each RELEASE goes out along with the next
+    // SAVEPOINT.
+    for (int i{0}; i < 5; ++i)
+    {
+      pqxx::subtransaction sub{trans, "row", pqxx::begin_policy::lazy};
+      try
+      {
+        sub.exec_params0("INSERT INTO foo(x) VALUES (10 / $1)", i);
+        sub.commit();
+      }
+      catch (pqxx::sql_error const &)
+      {
+        sub.abort();
+      }
+    }
+    PQXX_CHECK_EQUAL(count_rows(trans), 4, "Wrong rows after isolation.");
+
+    // Nested subtransactions, committed right before their parent.
+    {
+      pqxx::subtransaction outer{trans, "outer"};
+      {
+        pqxx::subtransaction inner{outer, "inner"};
+        insert_row(inner);
+        inner.commit();
+      }
+      outer.commit();
+    }
+    PQXX_CHECK_EQUAL(count_rows(trans), 5, "Nested work got lost.");
+    trans.commit();
+  }
+
+  // Committing a subtransaction must not drop an earlier sibling's RELEASE.
+  {
+    pqxx::work trans{conn};
+    std::string first_name;
+    {
+      pqxx::subtransaction first{trans, "first"};
+      first_name = first.name();
+      insert_row(first);
+      first.commit();
+    }
+    {
+      pqxx::subtransaction second{trans, "second", pqxx::begin_policy::lazy};
+      second.set_write_behind(true);
+      insert_row(second);
+      second.commit();
+    }
+    PQXX_CHECK_THROWS(
+      trans.exec0("ROLLBACK TO SAVEPOINT " + trans.quote_name(first_name)),
+      pqxx::sql_error, "Sibling's commit dropped an earlier RELEASE.");
+  }
+
+  // Skipping a subtransaction's RELEASE must not hide an error that it
+  // swallowed.
+  pqxx::work trans{conn};
+  {
+    pqxx::subtransaction sub{trans};
+    try
+    {
+      sub.exec0("SELECT 1 / 0");
+    }
+    catch (pqxx::sql_error const &)
+    {}
+    sub.commit();
+  }
+  PQXX_CHECK_THROWS(
+    trans.commit(), pqxx::sql_error,
+    "Commit of failed transaction looked successful.");
+}
+
+
 PQXX_REGISTER_TEST(test_subtransaction);
+PQXX_REGISTER_TEST(test_subtransaction_release_is_deferred);
 } // namespace
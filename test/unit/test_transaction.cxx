@@ -126,5 +126,160 @@ void test_transaction()
 }
 
 
+void test_lazy_begin()
+{
+  pqxx::connection c;
+  c.prepare("lazy_begin", "SELECT $1::integer");
+
+  // The first statement, whatever its kind, runs inside the transaction.
+  for (int kind{0}; kind < 3; ++kind)
+  {
+    pqxx::work tx{c, pqxx::begin_policy::lazy};
+    if (kind == 0)
+      tx.exec1("SELECT 1");
+    else if (kind == 1)
+      tx.exec_params1("SELECT $1::integer", 1);
+    else
+      tx.exec_prepared1("lazy_begin", 1);
+    PQXX_CHECK(
+      tx.query_value<bool>("SELECT now() <> statement_timestamp()"),
+      "Lazy transaction did not start with first statement.");
+    tx.commit();
+  }
+
+  // A lazy transaction can roll back.
+  {
+    pqxx::work tx{c, "lazy", pqxx::begin_policy::lazy};
+    tx.exec_params0("CREATE TEMP TABLE lazy_begin (x integer)");
+  }
+  pqxx::nontransaction check{c};
+  PQXX_CHECK_EQUAL(
+    check.query_value<int>("SELECT count(*) FROM pg_class "
+                           "WHERE relname = 'lazy_begin'"),
+    0, "Lazy transaction did not roll back.");
+  check.commit();
+
+  // Lazy subtransactions, in a lazy transaction.
+  pqxx::work tx{c, pqxx::begin_policy::lazy};
+  {
+    pqxx::subtransaction empty{tx, "empty", pqxx::begin_policy::lazy};
+    empty.commit();
+  }
+  {
+    pqxx::subtransaction sub{tx, "sub", pqxx::begin_policy::lazy};
+    sub.exec0("CREATE TEMP TABLE lazy_begin (x integer)");
+  }
+  PQXX_CHECK_EQUAL(
+    tx.query_value<int>("SELECT count(*) FROM pg_class "
+                        "WHERE relname = 'lazy_begin'"),
+    0, "Lazy subtransaction did not roll back.");
+  tx.commit();
+}
+
+
+void test_write_behind()
+{
+  pqxx::connection c;
+  c.prepare("write_behind", "INSERT INTO write_behind (x) VALUES ($1)");
+  {
+    pqxx::work tx{c};
+    tx.exec0("CREATE TEMP TABLE write_behind (x integer)");
+    tx.commit();
+  }
+
+  pqxx::work tx{c, pqxx::begin_policy::lazy};
+  tx.set_write_behind(true);
+  PQXX_CHECK(tx.write_behind(), "Write-behind mode did not stick.");
+  tx.exec0("INSERT INTO write_behind (x) VALUES (1)");
+  tx.exec_params0("INSERT INTO write_behind (x) VALUES ($1)", 2);
+  tx.exec_prepared0("write_behind", 3);
+  PQXX_CHECK_EQUAL(
+    tx.query_value<int>("SELECT sum(x) FROM write_behind"), 6,
+    "Queued statements did not execute before a read.");
+
+  // Queued statements go out with the commit.
+  tx.exec_prepared0("write_behind", 4);
+  tx.commit();
+  pqxx::work tx2{c};
+  PQXX_CHECK_EQUAL(
+    tx2.query_value<int>("SELECT sum(x) FROM write_behind"), 10,
+    "Queued statement did not go out with commit.");
+
+  // Errors come back as the failing statement's own.
+  tx2.set_write_behind(true);
+  tx2.exec0("INSERT INTO write_behind (x) VALUES (5)");
+  std::string const bad{"INSERT INTO write_behind (x) VALUES ('x')"};
+  tx2.exec0(bad);
+  tx2.exec0("INSERT INTO write_behind (x) VALUES (6)");
+  try
+  {
+    tx2.exec_params1("SELECT $1::integer", 1);
+    PQXX_CHECK_NOTREACHED("Failing write-behind statement went unnoticed.");
+  }
+  catch (pqxx::sql_error const &e)
+  {
+    PQXX_CHECK_EQUAL(e.query(), bad, "Error pinned on wrong statement.");
+  }
+  tx2.abort();
+
+  // A statement that fails at commit does not leave the connection stuck in
+  // a failed transaction.
+  {
+    pqxx::work failing{c};
+    failing.set_write_behind(true);
+    failing.exec0(bad);
+    PQXX_CHECK_THROWS(
+      failing.commit(), pqxx::sql_error,
+      "Write-behind statement failed silently at commit.");
+  }
+  {
+    pqxx::work next{c};
+    PQXX_CHECK_EQUAL(
+      next.query_value<int>("SELECT sum(x) FROM write_behind"), 10,
+      "Connection unusable after write-behind failure at commit.");
+    next.commit();
+  }
+
+  // Aborting discards queued statements.
+  pqxx::work tx3{c};
+  tx3.set_write_behind(true);
+  tx3.exec0("DROP TABLE write_behind");
+  tx3.abort();
+
+  // The same goes for a transaction with a nested subtransaction.  Here the
+  // queue holds a failing statement, then a savepoint with its own queued
+  // statement and deferred RELEASE.
+  {
+    pqxx::work outer{c, pqxx::begin_policy::lazy};
+    outer.set_write_behind(true);
+    outer.exec0(bad);
+    {
+      pqxx::subtransaction sub{outer, "nested", pqxx::begin_policy::lazy};
+      sub.set_write_behind(true);
+      sub.exec0("INSERT INTO write_behind (x) VALUES (100)");
+      PQXX_CHECK_THROWS(
+        sub.commit(), pqxx::sql_error,
+        "Failing outer statement went unnoticed.");
+    }
+    outer.abort();
+  }
+  pqxx::work tx4{c};
+  PQXX_CHECK_EQUAL(
+    tx4.query_value<int>("SELECT sum(x) FROM write_behind"), 10,
+    "Aborted write-behind statements had an effect.");
+  tx4.exec0("DROP TABLE write_behind");
+  tx4.commit();
+
+  // Without a real transaction, there is nothing to batch statements into.
+  pqxx::nontransaction ntx{c};
+  PQXX_CHECK_THROWS(
+    ntx.set_write_behind(true), pqxx::usage_error,
+    "Nontransaction accepted write-behind mode.");
+  PQXX_CHECK(not ntx.write_behind(), "Refused write-behind mode stuck.");
+}
+
+
 PQXX_REGISTER_TEST(test_transaction);
+PQXX_REGISTER_TEST(test_lazy_begin);
+PQXX_REGISTER_TEST(test_write_behind);
 } // namespace
@@ -123,5 +123,75 @@ void test_transactor()
 }
 
 
+void test_retry_policy()
+{
+  using kind = pqxx::retry_policy::failure_kind;
+  PQXX_CHECK_THROWS(
+    pqxx::retry_policy{0}, pqxx::argument_error,
+    "Zero attempts were accepted.");
+
+  PQXX_CHECK(
+    pqxx::retry_policy::classify(
+      pqxx::serialization_failure{"Serialization", "", "40001"}) ==
+      kind::conflict,
+    "Serialization failure is not a conflict.");
+  PQXX_CHECK(
+    pqxx::retry_policy::classify(pqxx::sql_error{"Lock", "", "55P03"}) ==
+      kind::conflict,
+    "Lock failure is not a conflict.");
+  PQXX_CHECK(
+    pqxx::retry_policy::classify(pqxx::transaction_rollback{"Rollback"}) ==
+      kind::rollback,
+    "Transaction rollback misclassified.");
+  PQXX_CHECK(
+    pqxx::retry_policy::classify(pqxx::sql_error{"Syntax", "", "42601"}) ==
+      kind::fatal,
+    "Syntax error is considered retryable.");
+
+  pqxx::retry_policy policy{4, std::chrono::milliseconds{1}};
+  int reconnects{0};
+  policy.set_reconnect([&reconnects] { ++reconnects; });
+
+  int counter{0};
+  auto const result{pqxx::perform(
+    [&counter] {
+      ++counter;
+      if (counter == 1)
+        throw pqxx::deadlock_detected{"Deadlock", "", "40P01"};
+      if (counter == 2)
+        throw pqxx::broken_connection{};
+      return counter;
+    },
+    policy)};
+  PQXX_CHECK_EQUAL(result, 3, "Wrong result from perform().");
+  PQXX_CHECK_EQUAL(policy.tries(), 3, "Wrong number of tries counted.");
+  PQXX_CHECK_EQUAL(policy.conflicts(), 1, "Wrong number of conflicts.");
+  PQXX_CHECK_EQUAL(reconnects, 1, "Reconnect hook not called once.");
+
+  // Errors that aren't worth retrying go straight through.
+  counter = 0;
+  PQXX_CHECK_THROWS(
+    pqxx::perform(
+      [&counter] {
+        ++counter;
+        throw pqxx::sql_error{"Syntax", "", "42601"};
+      },
+      policy),
+    pqxx::sql_error, "Fatal error did not propagate.");
+  PQXX_CHECK_EQUAL(counter, 1, "Retried fatal error.");
+
+  // The policy gives up after its maximum number of attempts.
+  policy.reset_counters();
+  PQXX_CHECK_THROWS(
+    pqxx::perform(
+      [] { throw pqxx::serialization_failure{"Conflict", "", "40001"}; },
+      policy),
+    pqxx::serialization_failure, "Conflict did not propagate.");
+  PQXX_CHECK_EQUAL(policy.tries(), 4, "Wrong number of attempts.");
+  PQXX_CHECK_EQUAL(policy.conflicts(), 4, "Conflicts not all counted.");
+}
+
+
 PQXX_REGISTER_TEST(test_transactor);
+PQXX_REGISTER_TEST(test_retry_policy);
 } // namespace